@@ -12,6 +12,9 @@
 #include "kernel.h"
 #include "memory.h"
 #include "pcb.h"
+#include "shm.h"
+#include "mmap.h"
+#include "swap.h"
 
 KernelContext *KCSwitch(KernelContext *kc_in, void *curr_pcb_p, void *next_pcb_p) {
     if (curr_pcb_p != NULL) {
@@ -21,14 +24,14 @@ KernelContext *KCSwitch(KernelContext *kc_in, void *curr_pcb_p, void *next_pcb_p
         TracePrintf(3, "KCSwitch: From PID %d to PID %d.\n", curr_proc ? curr_proc->pid : -1, next_proc->pid);
 
         // Copy the current KernelContext (kc_in) into the old PCB
-        memcpy(&curr_proc->kernel_context, kc_in, sizeof(KernelContext));
+        memcpy(&curr_proc->cold->kernel_context, kc_in, sizeof(KernelContext));
 
         // Set the next process
         current_process = next_proc;
         next_proc->state = PROCESS_RUNNING;
 
         // Update the global current_process variable
-        map_kernel_stack(next_proc->kernel_stack);
+        map_kernel_stack(next_proc->cold->kernel_stack);
 
         // Change Region 1 Page Table Base Register (REG_PTBR1) to the new PCB's Region 1 page table
         WriteRegister(REG_PTBR1, (unsigned long)next_proc->region1_pt);
@@ -38,7 +41,7 @@ KernelContext *KCSwitch(KernelContext *kc_in, void *curr_pcb_p, void *next_pcb_p
 
         // Return a pointer to the KernelContext in the new PCB
         TracePrintf(0, "Returning from KCSwitch\n");
-        return &next_proc->kernel_context;
+        return &next_proc->cold->kernel_context;
     } else {
         pcb_t *next_proc = (pcb_t *)next_pcb_p;
 
@@ -47,7 +50,7 @@ KernelContext *KCSwitch(KernelContext *kc_in, void *curr_pcb_p, void *next_pcb_p
         next_proc->state = PROCESS_RUNNING;
 
         // Update the global current_process variable
-        map_kernel_stack(next_proc->kernel_stack);
+        map_kernel_stack(next_proc->cold->kernel_stack);
 
         // Change Region 1 Page Table Base Register (REG_PTBR1) to the new PCB's Region 1 page table
         WriteRegister(REG_PTBR1, (unsigned long)next_proc->region1_pt);
@@ -56,36 +59,48 @@ KernelContext *KCSwitch(KernelContext *kc_in, void *curr_pcb_p, void *next_pcb_p
         WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_ALL);  // Flush all TLB entries for safety
 
         TracePrintf(0, "Returning from KCSwitch\n");
-        return &next_proc->kernel_context;
+        return &next_proc->cold->kernel_context;
     }
 }
 
-KernelContext *KCCopy(KernelContext *kc_in, void *new_pcb_p, void *na) {
+KernelContext *KCCopy(KernelContext *kc_in, void *new_pcb_p, void *live_sp) {
     pcb_t *new_proc = (pcb_t *)new_pcb_p;
     TracePrintf(1, "KCCopy: Setting up kernel context for PID %d.\n", new_proc->pid);
 
     // Save the incoming KernelContext (kc_in) into the new PCB's kernel_context field.
     // This kc_in contains the state of the caller function just before KernelContextSwitch was invoked.
-    memcpy(&new_proc->kernel_context, kc_in, sizeof(KernelContext));
+    memcpy(&new_proc->cold->kernel_context, kc_in, sizeof(KernelContext));
 
     int num_kernel_stack_pages = KERNEL_STACK_MAXSIZE / PAGESIZE;
-    char *current_kernel_stack_base = (char *)KERNEL_STACK_BASE;
+
+    // KCCopy runs on KernelContextSwitch's own stack, so the bound comes from a local in the caller's frame.
+    // The stack grows down: everything above that page is live, plus one page of slack for the frames
+    // KernelContextSwitch pushes below the caller before it saves the context. NULL copies the whole stack.
+    unsigned int live = KERNEL_STACK_BASE;
+    if (live_sp != NULL && DOWN_TO_PAGE(live_sp) - PAGESIZE > KERNEL_STACK_BASE) {
+        live = DOWN_TO_PAGE(live_sp) - PAGESIZE;
+    }
 
     for (int i = 0; i < num_kernel_stack_pages; i++) {
         // Get the physical frame number (PFN) for the corresponding page in the new kernel stack's page table.
-        pte_t *new_stack_pte = new_proc->kernel_stack + i;  // Assuming contiguous PTEs for kernel stack in new_proc->kernel_stack
+        pte_t *new_stack_pte = new_proc->cold->kernel_stack + i;  // Assuming contiguous PTEs for kernel stack in new_proc->cold->kernel_stack
         int dest_pfn = new_stack_pte->pfn;
+        new_stack_pte->valid = 1;
+        new_stack_pte->prot = PROT_READ | PROT_WRITE;
 
-        // Temporarily map the destination frame into Region 0 for copying.
-        setup_temp_mapping(dest_pfn);
+        unsigned int page_start = (KSTACK_START_PAGE + i) << PAGESHIFT;
+        unsigned int page_end = page_start + PAGESIZE;
+        if (page_end <= live) continue;  // Untouched, the frame is already zero
+        unsigned int from = (live > page_start) ? live : page_start;
 
-        // Copy contents of the current kernel stack page to the temporarily mapped destination
-        memcpy((void *)TEMP_MAPPING_VADDR, (void *)((KSTACK_START_PAGE + i) << PAGESHIFT), PAGESIZE);
+        // Map the destination frame through the kernel mapping window for copying.
+        char *dest = kmap_frame(dest_pfn);
 
-        // Remove the temporary mapping after copying
-        remove_temp_mapping();
-        new_stack_pte->valid = 1;
-        new_stack_pte->prot = PROT_READ | PROT_WRITE;
+        // Copy the live part of the current kernel stack page to the mapped destination
+        memcpy(dest + (from - page_start), (void *)from, page_end - from);
+
+        // Unpin the window slot, the mapping stays cached for reuse
+        kunmap_frame(dest);
     }
 
     WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_KSTACK);
@@ -97,20 +112,37 @@ void CopyPageTable(pcb_t *parent, pcb_t *child) {
     pte_t *child_pt = child->region1_pt;
 
     for (int i = 0; i < NUM_PAGES_REGION1; i++) {
-        if (parent_pt[i].valid == 1) {
+        // Pages the pager is holding are brought back so they can be copied
+        if (swap_holds(parent, i)) swap_settle(parent, i);
+        if (parent_pt[i].valid == 1 && parent->cold->page_meta[i].cow) {
+            // Untouched zero pages stay on the zero page in the child too
+            map_zero_page(child, i);
+        } else if (parent_pt[i].valid == 1 && shm_is_shared_page(parent, i)) {
+            // Shared segments stay shared, the child just takes a reference on the frame
+            frame_ref(parent_pt[i].pfn);
+            child_pt[i] = parent_pt[i];
+        } else if (parent_pt[i].valid == 1) {
+            // Allocating the child's frame may page something out, but not the page being copied
+            swap_pin(parent, i);
             int child_frame = allocate_frame();
             child_pt[i].pfn = child_frame;
             TracePrintf(0, "CopyPageTable: child process page table entry = %d, with physical frame number %d\n", i, child_frame);
 
             unsigned int parent_addr = (i + NUM_PAGES_REGION1) << PAGESHIFT;
-            setup_temp_mapping(child_frame);  // Temporary map the frame to the scratch address
-            memcpy((void *)TEMP_MAPPING_VADDR, (void *)parent_addr, PAGESIZE);
-            remove_temp_mapping();
+            void *dest = kmap_frame(child_frame);  // Map the frame through the kernel mapping window
+            memcpy(dest, (void *)parent_addr, PAGESIZE);
+            kunmap_frame(dest);
 
             child_pt[i].prot = parent_pt[i].prot;
             child_pt[i].valid = 1;
+            frame_set_owner(child_frame, child, i);
         }
     }
+    shm_copy_maps(parent, child);
+    mmap_copy_regions(parent, child);
+    // Heap pages that were never touched are left unmapped in the child as well
+    child->cold->heap_base = parent->cold->heap_base;
+    child->cold->brk = parent->cold->brk;
 }
 
 // void CopyPageTable(pcb_t *parent, pcb_t *child) {
@@ -129,31 +161,6 @@ void CopyPageTable(pcb_t *parent, pcb_t *child) {
 //     }
 // }
 
-/**
- * @brief Sets up a temporary mapping in Region 0 for a given physical frame.
- * @param pfn The physical frame number to map.
- * @return The virtual address where the frame is mapped, or NULL on error.
- */
-void setup_temp_mapping(int pfn) {
-    TracePrintf(1, "setup_temp_mapping: Mapping PFN %d to temporary address %p.\n", pfn, TEMP_MAPPING_VADDR);
-    int vpn = TEMP_MAPPING_VADDR >> PAGESHIFT;
-    region0_pt[vpn].valid = 1;
-    region0_pt[vpn].pfn = pfn;
-    region0_pt[vpn].prot = PROT_READ | PROT_WRITE;
-    WriteRegister(REG_TLB_FLUSH, TEMP_MAPPING_VADDR);
-}
-
-/**
- * @brief Removes a temporary mapping from Region 0.
- * @param addr The virtual address of the temporary mapping to remove.
- */
-void remove_temp_mapping(void) {
-    // Invalidate the PTE for the given virtual address 'addr' in region0_pt.
-    TracePrintf(0, "remove_temp_mapping: removing mapping for virtual page number: %d\n", TEMP_MAPPING_VADDR >> PAGESHIFT);
-    int vpn = TEMP_MAPPING_VADDR >> PAGESHIFT;
-    region0_pt[vpn].valid = 0;
-}
-
 /**
  * @brief Maps the kernel stack of the current process (identified by its physical frames) into Region 0.
  *
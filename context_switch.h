@@ -10,7 +10,6 @@
 #include <hardware.h>
 #include "kernel.h"
 
-#define TEMP_MAPPING_VADDR (KERNEL_STACK_BASE - PAGESIZE)
 #define KSTACK_START_PAGE (KERNEL_STACK_BASE >> PAGESHIFT)
 #define NUM_PAGES_REGION1 (VMEM_1_SIZE / PAGESIZE)
 
@@ -46,42 +45,27 @@ KernelContext *KCSwitch(KernelContext *kc_in, void *curr_pcb_p, void *next_pcb_p
  *
  * This function is called by KernelContextSwitch when a new process is being
  * created (e.g., during a Fork syscall). It copies the kernel context and
- * kernel stack contents from the current process to the new process.
+ * the live part of the kernel stack from the current process to the new
+ * process, from one page below the page holding live_sp up to
+ * KERNEL_STACK_LIMIT. KCCopy itself runs on KernelContextSwitch's separate
+ * stack, so the bound has to come from the caller.
+ * The rest of the new stack keeps the zeroed frames from InitializeKernelStack.
  *
  * @param kc_in A pointer to a temporary copy of the current kernel context
  * of the process that is initiating the copy (the parent).
  * @param new_pcb_p A void pointer to the PCB of the new (child) process.
- * @param not_used This parameter is not used in KCCopy.
+ * @param live_sp The address of a local in the caller's frame, or NULL to copy the whole stack.
  *
  * @return A pointer to the original kernel context (kc_in). This ensures the
  * parent process continues its execution after the cloning operation.
  * Returns NULL on failure to copy the kernel stack.
  */
-KernelContext *KCCopy(KernelContext *kc_in, void *new_pcb_p, void *not_used);
+KernelContext *KCCopy(KernelContext *kc_in, void *new_pcb_p, void *live_sp);
 
 
 void CopyPageTable(pcb_t *parent, pcb_t *child);
 
 
-/**
- * Setup temporary mapping for kernel stack
- * Creates a temporary mapping to access a kernel stack frame
- *
- * @param frame Physical frame to map
- * @return Virtual address of temporary mapping, or NULL on failure
- */
-void setup_temp_mapping(int frame);
-
-
-/**
- * Remove temporary mapping
- * Removes a temporary mapping created by setup_temp_mapping
- *
- * @param addr Virtual address to unmap
- */
-void remove_temp_mapping(void);
-
-
 /**
  * Map the kernel stack for a process
  * Maps the kernel stack pages into the Region 0 page table
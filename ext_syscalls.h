@@ -0,0 +1,246 @@
+/**
+ * Date: 5/20/25
+ * File: ext_syscalls.h
+ * Description: Extended kernel calls shared by the kernel and user programs
+ *
+ * The standard kernel call numbers are fixed by yuser.h, so every call this
+ * kernel adds on top of them goes through Custom0. The first argument picks
+ * the operation and the remaining three are passed through in regs[0..2].
+ */
+
+#ifndef _EXT_SYSCALLS_H_
+#define _EXT_SYSCALLS_H_
+
+#include <yuser.h>
+
+// Operation numbers for the extended kernel calls
+typedef enum {
+    EXT_SET_PRIORITY,
+    EXT_GET_PRIORITY,
+    EXT_RWLOCK_INIT,
+    EXT_RWLOCK_ACQUIRE_READ,
+    EXT_RWLOCK_ACQUIRE_WRITE,
+    EXT_RWLOCK_RELEASE,
+    EXT_SEM_INIT,
+    EXT_SEM_WAIT,
+    EXT_SEM_POST,
+    EXT_GET_TICKS,
+    EXT_FUTEX_WAIT,
+    EXT_FUTEX_WAKE,
+    EXT_BARRIER_INIT,
+    EXT_BARRIER_WAIT,
+    EXT_LOCK_ACQUIRE_TIMED,
+    EXT_CVAR_WAIT_TIMED,
+    EXT_PIPE_READ_TIMED,
+    EXT_POLL,
+    EXT_PIPE_SET_FLAGS,
+    EXT_PIPE_INIT_SIZED,
+    EXT_PIPE_SPLICE,
+    EXT_SHM_CREATE,
+    EXT_SHM_ATTACH,
+    EXT_MMAP,
+    EXT_MUNMAP,
+    EXT_PROC_INFO,
+    EXT_SWITCH_STATS,
+    EXT_SET_TICKETS,
+    EXT_RT_SET,
+    EXT_NUM_CALLS
+} ext_op_t;
+
+// FutexWait return when the value no longer matched, so the caller should re-check
+#define FUTEX_VALUE_CHANGED 1
+
+// BarrierWait return for the process that arrived last and released the phase
+#define BARRIER_LAST 1
+
+// Return of a timed wait that gave up before it was woken
+#define WAIT_TIMEOUT (-2)
+
+// Return of a non-blocking call that could not make any progress
+#define WOULD_BLOCK (-3)
+
+// Pipe flags for PipeSetFlags
+#define PIPE_NONBLOCK 0x1
+
+// A user buffer, for calls with more arguments than Custom0 can carry
+typedef struct ext_buf {
+    void *buf;
+    int len;
+} ext_buf_t;
+
+// Poll entry types and event bits
+#define POLL_PIPE 0
+#define POLL_TTY 1
+#define POLL_READ 0x1
+#define POLL_WRITE 0x2
+#define POLL_ERR 0x4
+
+// One object to watch in a Poll call, revents is filled in by the kernel
+typedef struct poll_entry {
+    int id;        // Pipe id or terminal number
+    int type;      // POLL_PIPE or POLL_TTY
+    int events;    // POLL_READ and/or POLL_WRITE
+    int revents;   // Events that are ready, or POLL_ERR
+} poll_entry_t;
+
+// Mmap flag to write the mapped pages back to the file on Munmap, Exit or Exec
+#define MMAP_WRITEBACK 0x1
+
+// Arguments of an Mmap call, addr is filled in by the kernel
+typedef struct mmap_args {
+    char *path;    // Host file to map
+    int offset;    // Page aligned offset into the file
+    int len;       // Bytes to map
+    int prot;      // PROT_READ, PROT_WRITE and PROT_EXEC bits
+    int flags;     // MMAP_WRITEBACK
+    void *addr;    // Where the mapping was placed
+} mmap_args_t;
+
+// Memory statistics of a process returned by ProcInfo
+typedef struct proc_info {
+    int pid;
+    int priority;
+    int resident_pages;  // Region 1 pages backed by a frame
+    int swapped_pages;   // Region 1 pages in the swap file
+    int minor_faults;    // Faults resolved without I/O
+    int major_faults;    // Faults that read from the swap file or a mapped file
+    int cow_breaks;      // Copy on write pages given a private copy
+    int working_set;     // Pages touched in the last sampling interval
+} proc_info_t;
+
+// Kernel wide context switch counters returned by SwitchStats
+typedef struct switch_stats {
+    int switches;     // Switches made by the scheduler since boot
+    int uctxt_bytes;  // Bytes of UserContext the kernel has copied since boot
+} switch_stats_t;
+
+/* ------------------------------------------------------------------ User wrappers -------------------------------------------------------- */
+
+static inline int SetPriority(int priority) {
+    return Custom0(EXT_SET_PRIORITY, priority, 0, 0);
+}
+
+static inline int GetPriority(void) {
+    return Custom0(EXT_GET_PRIORITY, 0, 0, 0);
+}
+
+static inline int RWLockInit(int *rwlock_idp) {
+    return Custom0(EXT_RWLOCK_INIT, (int)rwlock_idp, 0, 0);
+}
+
+static inline int AcquireRead(int rwlock_id) {
+    return Custom0(EXT_RWLOCK_ACQUIRE_READ, rwlock_id, 0, 0);
+}
+
+static inline int AcquireWrite(int rwlock_id) {
+    return Custom0(EXT_RWLOCK_ACQUIRE_WRITE, rwlock_id, 0, 0);
+}
+
+static inline int RWLockRelease(int rwlock_id) {
+    return Custom0(EXT_RWLOCK_RELEASE, rwlock_id, 0, 0);
+}
+
+static inline int SemaphoreInit(int *sem_idp, int count) {
+    return Custom0(EXT_SEM_INIT, (int)sem_idp, count, 0);
+}
+
+static inline int SemaphoreWait(int sem_id, int n) {
+    return Custom0(EXT_SEM_WAIT, sem_id, n, 0);
+}
+
+static inline int SemaphorePost(int sem_id, int n) {
+    return Custom0(EXT_SEM_POST, sem_id, n, 0);
+}
+
+static inline int GetTicks(void) {
+    return Custom0(EXT_GET_TICKS, 0, 0, 0);
+}
+
+static inline int FutexWait(int *addr, int val) {
+    return Custom0(EXT_FUTEX_WAIT, (int)addr, val, 0);
+}
+
+static inline int FutexWake(int *addr, int n) {
+    return Custom0(EXT_FUTEX_WAKE, (int)addr, n, 0);
+}
+
+static inline int BarrierInit(int *barrier_idp, int parties) {
+    return Custom0(EXT_BARRIER_INIT, (int)barrier_idp, parties, 0);
+}
+
+static inline int BarrierWait(int barrier_id) {
+    return Custom0(EXT_BARRIER_WAIT, barrier_id, 0, 0);
+}
+
+static inline int AcquireTimed(int lock_id, int ticks) {
+    return Custom0(EXT_LOCK_ACQUIRE_TIMED, lock_id, ticks, 0);
+}
+
+static inline int CvarWaitTimed(int cvar_id, int lock_id, int ticks) {
+    return Custom0(EXT_CVAR_WAIT_TIMED, cvar_id, lock_id, ticks);
+}
+
+static inline int PipeReadTimed(int pipe_id, void *buf, int len, int ticks) {
+    ext_buf_t b = { buf, len };
+    return Custom0(EXT_PIPE_READ_TIMED, pipe_id, (int)&b, ticks);
+}
+
+// Negative ticks waits forever, 0 checks readiness without blocking
+static inline int Poll(poll_entry_t *entries, int n, int ticks) {
+    return Custom0(EXT_POLL, (int)entries, n, ticks);
+}
+
+static inline int PipeSetFlags(int pipe_id, int flags) {
+    return Custom0(EXT_PIPE_SET_FLAGS, pipe_id, flags, 0);
+}
+
+static inline int PipeInitSized(int *pipe_idp, int capacity) {
+    return Custom0(EXT_PIPE_INIT_SIZED, (int)pipe_idp, capacity, 0);
+}
+
+// Never blocks, returns the bytes moved (0 when src is empty or dst is full)
+static inline int PipeSplice(int src_pipe_id, int dst_pipe_id, int n) {
+    return Custom0(EXT_PIPE_SPLICE, src_pipe_id, dst_pipe_id, n);
+}
+
+// Segments are freed with Reclaim, attached mappings stay valid until Exit or Exec
+static inline int ShmCreate(int *shm_idp, int size) {
+    return Custom0(EXT_SHM_CREATE, (int)shm_idp, size, 0);
+}
+
+static inline int ShmAttach(int shm_id, void **addrp) {
+    return Custom0(EXT_SHM_ATTACH, shm_id, (int)addrp, 0);
+}
+
+static inline int Mmap(char *path, int offset, int len, int prot, int flags, void **addrp) {
+    mmap_args_t a = { path, offset, len, prot, flags, 0 };
+    int rc = Custom0(EXT_MMAP, (int)&a, 0, 0);
+    if (rc != ERROR) *addrp = a.addr;
+    return rc;
+}
+
+static inline int Munmap(void *addr) {
+    return Custom0(EXT_MUNMAP, (int)addr, 0, 0);
+}
+
+// pid 0 means the caller, otherwise pid must be the caller or one of its children
+static inline int ProcInfo(int pid, proc_info_t *info) {
+    return Custom0(EXT_PROC_INFO, pid, (int)info, 0);
+}
+
+static inline int SwitchStats(switch_stats_t *stats) {
+    return Custom0(EXT_SWITCH_STATS, (int)stats, 0, 0);
+}
+
+// Only matters under the stride policy (boot with -sched=stride), pid 0 means the caller
+static inline int SetTickets(int pid, int tickets) {
+    return Custom0(EXT_SET_TICKETS, pid, tickets, 0);
+}
+
+// Run earliest deadline first with budget ticks every period ticks, period 0 leaves the real-time class.
+// Fails if the real-time processes would reserve more of the CPU than the kernel allows.
+static inline int RtSet(int period, int budget) {
+    return Custom0(EXT_RT_SET, period, budget, 0);
+}
+
+#endif /* _EXT_SYSCALLS_H_ */
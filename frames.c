@@ -4,9 +4,37 @@
 #include <yalnix.h>
 #include <ykernel.h>
 
-int *frame_bitMap;  // Bitmap to track free/used frames
+#include "swap.h"
+#include "memory.h"
+
+int *frame_bitMap;  // Reference count per frame, 0 means free
+int frame_count = 0;
+frame_owner_t *frame_owners = NULL;
+int zero_pfn = ERROR;
+
+static int zero_pool[ZERO_POOL_SIZE];  // Frames that are allocated and already zeroed
+static int zero_pool_count = 0;
 
 static void print_integer_array(int *array, int size, const char *array_name);
+static int take_free_frame(void);
+static void zero_frame(int pfn);
+
+// Claims the first free frame without falling back to the pool or the pager
+static int take_free_frame(void) {
+    for (int i = 0; i < frame_count; i++) {
+        if (frame_bitMap[i] == 0) {      // If the frame is free (0 means free, 1 means used)
+            frame_bitMap[i] = 1;         // Mark it as used
+            return i;
+        }
+    }
+    return ERROR;
+}
+
+static void zero_frame(int pfn) {
+    void *page = kmap_frame(pfn);
+    memset(page, 0, PAGESIZE);
+    kunmap_frame(page);
+}
 
 int allocate_frame(void) {
     // // Call the print function
@@ -14,20 +42,67 @@ int allocate_frame(void) {
     // print_integer_array(frame_bitMap, array_size, "frame_bitMap");
 
     // Iterate through the frame_bitMap to find a free frame
-    for (int i = 0; i < NUM_VPN; i++) {  // Assuming NUM_VPN is the total number of physical frames
-        if (frame_bitMap[i] == 0) {      // If the frame is free (0 means free, 1 means used)
-            frame_bitMap[i] = 1;         // Mark it as used
-            TracePrintf(1, "allocate_frame: Allocated frame %d\n", i);
-            return i;  // Return the physical frame number
-        }
+    int pfn = take_free_frame();
+    if (pfn != ERROR) {
+        TracePrintf(1, "allocate_frame: Allocated frame %d\n", pfn);
+        return pfn;  // Return the physical frame number
     }
-    TracePrintf(0, "allocate_frame: ERROR: No free physical frames available\n");
-    return ERROR;  // No free frames
+    // Zeroed frames are cheaper to give up than paging something out
+    if (zero_pool_count > 0) {
+        return zero_pool[--zero_pool_count];
+    }
+    TracePrintf(1, "allocate_frame: No free physical frames, asking the pager for one\n");
+    pfn = swap_evict();
+    if (pfn == ERROR) {
+        TracePrintf(0, "allocate_frame: ERROR: No free physical frames available\n");
+    }
+    return pfn;
+}
+
+int allocate_zeroed_frame(void) {
+    if (zero_pool_count > 0) {
+        return zero_pool[--zero_pool_count];
+    }
+    int pfn = allocate_frame();
+    if (pfn != ERROR) zero_frame(pfn);
+    return pfn;
+}
+
+void zero_pool_refill(void) {
+    for (int i = 0; i < ZERO_POOL_BATCH && zero_pool_count < ZERO_POOL_SIZE; i++) {
+        int pfn = take_free_frame();
+        if (pfn == ERROR) return;
+        zero_frame(pfn);
+        zero_pool[zero_pool_count++] = pfn;
+    }
+}
+
+void zero_page_init(void) {
+    zero_pfn = take_free_frame();
+    if (zero_pfn == ERROR) {
+        TracePrintf(0, "zero_page_init: ERROR: No frame left for the zero page\n");
+        return;
+    }
+    zero_frame(zero_pfn);
+    TracePrintf(1, "zero_page_init: Zero page is frame %d\n", zero_pfn);
+}
+
+void frame_set_owner(int pfn, struct pcb *proc, int vpn) {
+    frame_owners[pfn].proc = proc;
+    frame_owners[pfn].vpn = vpn;
+}
+
+void frame_ref(int pfn) {
+    if (pfn < 0 || pfn >= frame_count || frame_bitMap[pfn] == 0) {
+        TracePrintf(0, "frame_ref: ERROR: Frame %d is not allocated\n", pfn);
+        return;
+    }
+    frame_bitMap[pfn]++;
 }
 
 void free_frame(int pfn) {
     // Basic validation for the physical frame number
-    if (pfn < 0 || pfn >= NUM_VPN) {  // Assuming NUM_VPN is the total number of physical frames
+    if (pfn < 0 || pfn >= frame_count) {
         TracePrintf(0, "free_frame: ERROR: Invalid physical frame number %d\n", pfn);
         return;
     }
@@ -38,7 +113,12 @@ void free_frame(int pfn) {
         return;
     }
 
-    frame_bitMap[pfn] = 0;  // Mark the frame as free
+    // Shared frames stay in use until their last reference is dropped
+    if (--frame_bitMap[pfn] > 0) {
+        TracePrintf(1, "free_frame: Frame %d still has %d references\n", pfn, frame_bitMap[pfn]);
+        return;
+    }
+    frame_owners[pfn].proc = NULL;
     TracePrintf(0, "free_frame: Freed frame %d\n", pfn);
 }
 
@@ -1,13 +1,34 @@
+#ifndef _FRAMES_H_
+#define _FRAMES_H_
+
 
 #include <hardware.h>
 
-extern int *frame_bitMap;      // Bitmap to track free/used frames
+extern int *frame_bitMap;      // Reference count per frame, 0 means free
+extern int frame_count;        // Number of physical frames
+
+struct pcb;
+
+// Reverse map entry, the Region 1 page an unshared user frame backs
+typedef struct frame_owner {
+    struct pcb *proc;  // Owning process, NULL for kernel, shared or free frames
+    int vpn;           // Region 1 page number in the owner
+} frame_owner_t;
+
+extern frame_owner_t *frame_owners;  // Indexed by frame number, used by the pager
+
+// Number of pre-zeroed frames kept ready, and how many are zeroed per idle tick
+#define ZERO_POOL_SIZE 32
+#define ZERO_POOL_BATCH 4
+
+extern int zero_pfn;  // Shared read only frame of zeros, mapped copy on write
 
 /**
  * @brief Allocate a free physical frame
  *
  * Iterates through the global frame_bitMap to find an unused physical frame.
  * Marks the found frame as used and returns its physical frame number (pfn).
+ * When every frame is in use a Region 1 page is paged out to make room.
  *
  * @return Physical frame number on success, -1 if no free frames are available.
  */
@@ -15,11 +36,60 @@ int allocate_frame(void);
 
 
 /**
- * @brief Release a physical frame back to the free pool
+ * @brief Allocate a physical frame that is filled with zeros
+ *
+ * Takes a frame from the pre-zeroed pool when one is ready, otherwise
+ * allocates a frame and zeroes it on the spot.
  *
- * Marks the specified physical frame number (pfn) as free in the global frame_bitMap.
+ * @return Physical frame number on success, ERROR if no frame could be found.
+ */
+int allocate_zeroed_frame(void);
+
+
+/**
+ * @brief Zero a few free frames into the pool, called while the idle process runs
+ *
+ * Never pages anything out, it only uses frames that are already free.
+ */
+void zero_pool_refill(void);
+
+
+/**
+ * @brief Allocate and clear the shared zero frame, once virtual memory is enabled
+ */
+void zero_page_init(void);
+
+
+/**
+ * @brief Take another reference on an allocated frame
+ *
+ * Used when a frame is mapped by more than one page table (shared memory),
+ * each reference is dropped with free_frame.
+ *
+ * @param pfn Physical frame number to reference.
+ */
+void frame_ref(int pfn);
+
+
+/**
+ * @brief Record which Region 1 page a frame backs so the pager can evict it
+ *
+ * @param pfn Physical frame number.
+ * @param proc Process whose page table maps the frame.
+ * @param vpn Region 1 page number the frame is mapped at.
+ */
+void frame_set_owner(int pfn, struct pcb *proc, int vpn);
+
+
+/**
+ * @brief Release a reference on a physical frame
+ *
+ * Decrements the frame's count in the global frame_bitMap and returns it to the
+ * free pool once no references remain.
  * Performs basic validation to ensure the pfn is within valid bounds and was previously allocated.
  *
  * @param pfn Physical frame number to free.
  */
 void free_frame(int pfn);
+
+#endif /* _FRAMES_H_ */
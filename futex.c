@@ -0,0 +1,101 @@
+/**
+ * Date: 5/20/25
+ * File: futex.c
+ * Description: Futex implementation for Yalnix OS
+ */
+
+#include <yalnix.h>
+#include <ykernel.h>
+
+#include "futex.h"
+#include "sync.h"
+#include "ext_syscalls.h"
+#include "swap.h"
+#include "memory.h"
+
+static list_t futex_buckets[FUTEX_BUCKETS];
+
+static int futex_key(int *addr, unsigned int *key_out);
+
+void futex_init(void){
+    TracePrintf(1, "Enter futex_init.\n");
+    for(int i = 0; i < FUTEX_BUCKETS; i++){
+        list_init(&futex_buckets[i]);
+    }
+    TracePrintf(1, "Exit futex_init.\n");
+}
+
+// Translates a user address into the physical address used as the futex key
+// The pager leaves pages with futex waiters in their frame, so a queued key stays valid
+static int futex_key(int *addr, unsigned int *key_out){
+    unsigned int vaddr = (unsigned int)addr;
+    if(vaddr < VMEM_1_BASE || vaddr >= VMEM_1_LIMIT || (vaddr & (sizeof(int) - 1)) != 0){
+        TracePrintf(1, "ERROR, futex address %p is not an aligned region 1 address.\n", addr);
+        return ERROR;
+    }
+
+    // Resolve the page as if it were written, so an untouched BSS word gets its private frame now rather than
+    // on the waker's first atomic, and an untouched heap page is faulted in
+    if(user_buffer_ready(addr, sizeof(int), true) == ERROR){
+        TracePrintf(1, "ERROR, futex address %p is not mapped writable.\n", addr);
+        return ERROR;
+    }
+    int vpn = (vaddr - VMEM_1_BASE) >> PAGESHIFT;
+    pte_t entry = current_process->region1_pt[vpn];
+
+    *key_out = (entry.pfn << PAGESHIFT) | (vaddr & PAGEOFFSET);
+    return SUCCESS;
+}
+
+int futex_wait(int *addr, int val){
+    TracePrintf(1, "Enter futex_wait.\n");
+    unsigned int key;
+    if(futex_key(addr, &key) == ERROR){
+        return ERROR;
+    }
+
+    // The value check and the enqueue happen without anything else running in between,
+    // so a waker that changed the value first can never be missed
+    if(*addr != val){
+        TracePrintf(1, "Exit futex_wait, the value changed from %d to %d.\n", val, *addr);
+        return FUTEX_VALUE_CHANGED;
+    }
+
+    pcb_t *curr = current_process;
+    curr->cold->futex_key = key;
+    curr->cold->futex_vpn = ((unsigned int)addr - VMEM_1_BASE) >> PAGESHIFT;
+    curr->cold->page_meta[curr->cold->futex_vpn].futex_waiters++;
+    curr->state = PROCESS_BLOCKED;
+    insert_tail(&futex_buckets[(key >> 2) % FUTEX_BUCKETS], &curr->queue_node);
+    TracePrintf(1, "Exit futex_wait, process %d is blocked on key %x.\n", curr->pid, key);
+    return PCB_BLOCKED;
+}
+
+int futex_wake(int *addr, int n){
+    TracePrintf(1, "Enter futex_wake.\n");
+    unsigned int key;
+    if(futex_key(addr, &key) == ERROR){
+        return ERROR;
+    }
+
+    // Other keys can share the bucket, so only wake the matching waiters in arrival order
+    list_t *bucket = &futex_buckets[(key >> 2) % FUTEX_BUCKETS];
+    list_node_t *head = &bucket->head;
+    list_node_t *curr = head->next;
+    int woken = 0;
+    while(curr != head && woken < n){
+        list_node_t *next = curr->next;
+        pcb_t *waiter = pcb_from_queue_node(curr);
+        if(waiter->cold->futex_key == key){
+            list_remove(bucket, curr);
+            waiter->cold->page_meta[waiter->cold->futex_vpn].futex_waiters--;
+            waiter->state = PROCESS_DEFAULT;
+            add_to_ready_queue(waiter);
+            woken++;
+        }
+        curr = next;
+    }
+
+    TracePrintf(1, "Exit futex_wake, woke %d processes on key %x.\n", woken, key);
+    return woken;
+}
@@ -0,0 +1,44 @@
+/**
+ * Date: 5/20/25
+ * File: futex.h
+ * Description: Futex wait queues keyed by user address for Yalnix OS
+ */
+
+#ifndef _FUTEX_H_
+#define _FUTEX_H_
+
+#include <hardware.h>
+#include "pcb.h"
+
+// Number of wait queues the futex keys hash into
+#define FUTEX_BUCKETS 64
+
+/**
+ * Initialize the futex wait queues
+ */
+void futex_init(void);
+
+/**
+ * Block the current process on addr if *addr still holds val
+ *
+ * The queue is keyed by the physical address behind addr so processes
+ * sharing a frame share the queue. The page stays pinned in its frame
+ * until the process is woken.
+ *
+ * @param addr Region 1 address of an aligned int
+ * @param val Value the caller expects to find at addr
+ * @return PCB_BLOCKED if the process was queued, FUTEX_VALUE_CHANGED if
+ *         *addr no longer equals val, ERROR on a bad address
+ */
+int futex_wait(int *addr, int val);
+
+/**
+ * Wake up to n processes blocked on addr
+ *
+ * @param addr Region 1 address of an aligned int
+ * @param n Maximum number of processes to wake
+ * @return Number of processes woken, or ERROR on a bad address
+ */
+int futex_wake(int *addr, int n);
+
+#endif /* _FUTEX_H_ */
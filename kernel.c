@@ -21,6 +21,9 @@
 #include "syscalls.h"
 #include "traps.h"
 #include "load_program.h"
+#include "futex.h"
+#include "swap.h"
+#include "sched.h"
 #include "kernel.h"
 
 
@@ -34,6 +37,8 @@ void KernelStart(char *cmd_args[], unsigned int pmem_size, UserContext *uctxt) {
     // Initialize trap handlers
     trap_init();
     syscalls_init();
+    futex_init();
+    swap_init();
 
     // Initialize PCB system, which includes process queues
     if (init_pcb_system() != 0) {
@@ -48,11 +53,14 @@ void KernelStart(char *cmd_args[], unsigned int pmem_size, UserContext *uctxt) {
     pcb_t *idle_pcb = create_process();
     idle_process = idle_pcb;
 
-    idle_pcb->time_slice = 1;
     if(idle_pcb == NULL){
         TracePrintf(0, "ERROR, failed to initialize the idle pcb.n");
         Halt();
     }
+    idle_pcb->time_slice = 1;
+    // Idle never outranks real work
+    idle_pcb->base_priority = MIN_PRIORITY;
+    idle_pcb->priority = MIN_PRIORITY;
     
     // Attempt to get a frame for a location to put doidle
     int pfn = allocate_frame();
@@ -69,13 +77,19 @@ void KernelStart(char *cmd_args[], unsigned int pmem_size, UserContext *uctxt) {
     WriteRegister(REG_PTLR1, MAX_PT_LEN);
 
     // Set up the kernel stack of doidle, copy the user context into it, and set the pc and sp
-    idle_pcb->kernel_stack = InitializeKernelStack();
-    cpyuc(&idle_pcb->user_context, uctxt);
-    idle_pcb->user_context.pc = &DoIdle;                     // DoIdle is in your kernel.c
-    idle_pcb->user_context.sp = (void *)(VMEM_1_LIMIT - 5);  // Standard initial stack pointer
+    idle_pcb->cold->kernel_stack = InitializeKernelStack();
+    // Only the pc and sp differ from the boot trap frame, the rest is saved when idle first switches out
+    idle_pcb->cold->user_context.pc = &DoIdle;                     // DoIdle is in your kernel.c
+    idle_pcb->cold->user_context.sp = (void *)(VMEM_1_LIMIT - 5);  // Standard initial stack pointer
 
     // Now that idle is made turn on virtual memory
     enable_virtual_memory();
+    // The zero page is cleared through the scratch mapping, so it needs virtual memory on
+    zero_page_init();
+
+    // Kernel options come first, the init program's name and arguments follow
+    int first = sched_init(cmd_args);
+    if (cmd_args != NULL) cmd_args += first;
 
     // Determine the name of the initial program to load
     char *name = (cmd_args != NULL && cmd_args[0] != NULL) ? cmd_args[0] : "test/init";
@@ -89,8 +103,7 @@ void KernelStart(char *cmd_args[], unsigned int pmem_size, UserContext *uctxt) {
     }
 
     TracePrintf(0, "Initializing kernelStack for INIT_PCB\n");
-    init_pcb->kernel_stack = InitializeKernelStack();
-    cpyuc(&init_pcb->user_context, uctxt);
+    init_pcb->cold->kernel_stack = InitializeKernelStack();
 
     WriteRegister(REG_PTBR1, (unsigned int)init_pcb->region1_pt);
     WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
@@ -102,7 +115,8 @@ void KernelStart(char *cmd_args[], unsigned int pmem_size, UserContext *uctxt) {
     WriteRegister(REG_PTBR1, (unsigned int)idle_pcb->region1_pt);
     WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
     TracePrintf(1, "Cloning idle into init.\n");
-    if(KernelContextSwitch(KCCopy, (void *) init_pcb, NULL) == ERROR){
+    char live;
+    if(KernelContextSwitch(KCCopy, (void *) init_pcb, &live) == ERROR){
         TracePrintf(1, "Failed to clone idle into init.\n");
     }
 
@@ -115,13 +129,16 @@ void KernelStart(char *cmd_args[], unsigned int pmem_size, UserContext *uctxt) {
   if (switch_flag == 0) {
     add_to_ready_queue(init_pcb);
     switch_flag = 1;
-    cpyuc(uctxt, &idle_pcb->user_context);
+    uctxt->pc = idle_pcb->cold->user_context.pc;
+    uctxt->sp = idle_pcb->cold->user_context.sp;
     SetCurrentProcess(idle_pcb);
   }
   else {
     WriteRegister(REG_PTBR1, (unsigned int)init_pcb->region1_pt);
     WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-    cpyuc(uctxt, &init_pcb->user_context);
+    // LoadProgram only filled in the pc and sp
+    uctxt->pc = init_pcb->cold->user_context.pc;
+    uctxt->sp = init_pcb->cold->user_context.sp;
     SetCurrentProcess(init_pcb);
   }
 
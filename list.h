@@ -24,12 +24,31 @@ typedef struct list {
     int count;         // Number of nodes in the list
 } list_t;
 
+// Build with -DLIST_DEBUG to check the list invariants, otherwise they compile away
+#ifdef LIST_DEBUG
+#define LIST_ASSERT(cond) \
+    do { \
+        if (!(cond)) { \
+            TracePrintf(0, "LIST_ASSERT failed: %s at %s:%d\n", #cond, __FILE__, __LINE__); \
+            Halt(); \
+        } \
+    } while (0)
+#else
+#define LIST_ASSERT(cond) ((void)0)
+#endif
+
 /**
  * Initializes a new list
  * 
  * @param the new list to initialize
  */
-void list_init(list_t *new_list);
+static inline void list_init(list_t *new_list){
+    LIST_ASSERT(new_list != NULL);
+    new_list->count = 0;
+    // Initialize list sentinel nodes
+    new_list->head.prev = &new_list->head;
+    new_list->head.next = &new_list->head;
+}
 
 /**
  * Creates a new list from scratch
@@ -44,8 +63,29 @@ list_t *create_list(void);
  * @param the node to insert into the list
  * @param the list to insert the node into
  */
-void insert_tail(list_t* list, list_node_t *node);
-void insert_head(list_t *list, list_node_t *node);
+static inline void insert_tail(list_t *list, list_node_t *node){
+    LIST_ASSERT(list != NULL && node != NULL);
+    node->prev = list->head.prev;
+    node->next = &list->head;
+    list->head.prev->next = node;
+    list->head.prev = node;
+    list->count++;
+}
+
+/**
+ * Inserts a node at the head of the list
+ * 
+ * @param the list to insert the node into
+ * @param the node to insert into the list
+ */
+static inline void insert_head(list_t *list, list_node_t *node){
+    LIST_ASSERT(list != NULL && node != NULL);
+    node->prev = &list->head;
+    node->next = list->head.next;
+    list->head.next->prev = node;
+    list->head.next = node;
+    list->count++;
+}
 
 /**
  * Checks to see if list contains node
@@ -58,10 +98,18 @@ int list_contains(list_t *list, list_node_t *node);
 
 /**
  * Remove a node from a list
+ * The node must be linked into list
  *
  * @param node Node to remove
  */
-void list_remove(list_t *list, list_node_t *node);
+static inline void list_remove(list_t *list, list_node_t *node){
+    LIST_ASSERT(node->next != NULL && node->prev != NULL);
+    LIST_ASSERT(list->count > 0);
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next = node->prev = NULL;
+    list->count--;
+}
 
 
 /**
@@ -70,7 +118,10 @@ void list_remove(list_t *list, list_node_t *node);
  * @param list List to check
  * @return 1 if empty, 0 if not
  */
-int list_is_empty(list_t *list);
+static inline int list_is_empty(list_t *list){
+    LIST_ASSERT(list != NULL);
+    return list->count == 0;
+}
 
 /**
  * Pops the first node off the head of the list (if possible)
@@ -78,9 +129,27 @@ int list_is_empty(list_t *list);
  * @param the list to pop the node from
  * @return the first node in the list OR NULL if the list is empty
  */
-list_node_t* pop(list_t *list);
+static inline list_node_t *pop(list_t *list){
+    LIST_ASSERT(list != NULL);
+    if (list->count == 0) return NULL;
+    list_node_t *ret = list->head.next;
+    ret->next->prev = &list->head;
+    list->head.next = ret->next;
+    ret->next = ret->prev = NULL;
+    list->count--;
+    return ret;
+}
 
-list_node_t *peek(list_t *list);
+/**
+ * Looks at the first node of the list without removing it
+ * 
+ * @param the list to look in
+ * @return the first node in the list OR NULL if the list is empty
+ */
+static inline list_node_t *peek(list_t *list){
+    LIST_ASSERT(list != NULL);
+    return list->count == 0 ? NULL : list->head.next;
+}
 
 int clear_list(list_t *list);
 
@@ -10,6 +10,8 @@
 
 #include "memory.h"
 #include "pcb.h"
+#include "frames.h"
+#include "swap.h"
 
 /*
  * ==>> #include anything you need for your kernel here
@@ -134,7 +136,7 @@ int LoadProgram(char *name, char *args[], pcb_t *proc) {
      * ==>> proc->uc.sp = cp2;
      */
     // Rewrite the line from above to do what it's supposed to
-    proc->user_context.sp = cp2;
+    proc->cold->user_context.sp = cp2;
 
     /*
      * Now save the arguments in a separate buffer in region 0, since
@@ -148,6 +150,7 @@ int LoadProgram(char *name, char *args[], pcb_t *proc) {
     // Check to see if the malloc failed
     if (cp2 == NULL) {
         TracePrintf(1, "ERROR, malloc for cp2 failed in LoadProgram.\n");
+        close(fd);
         return ERROR;
     }
 
@@ -187,11 +190,16 @@ int LoadProgram(char *name, char *args[], pcb_t *proc) {
         int nf = allocate_frame();
         if (nf == ERROR) {
             TracePrintf(1, "ERROR, no new frames to allocate for LoadProgram.\n");
-            return ERROR;
+            // The old address space is already gone, so the caller has to kill the process
+            close(fd);
+            free(argbuf);
+            return KILL;
         }
         proc->region1_pt[i].valid = 1;
         proc->region1_pt[i].prot = PROT_READ | PROT_WRITE;
         proc->region1_pt[i].pfn = nf;
+        frame_set_owner(nf, proc, i);
+        swap_pin(proc, i);  // Filled in below, so it has to stay put until then
     }
     /*
      * ==>> Then, data. Allocate "data_npg" physical pages and map them starting at
@@ -201,18 +209,30 @@ int LoadProgram(char *name, char *args[], pcb_t *proc) {
      */
 
     TracePrintf(1, "Load_program: Allocating pages for data.\n");
+    // Pages that hold nothing but BSS start out on the shared zero page
+    int bss_pg1 = (UP_TO_PAGE(li.id_end) - VMEM_1_BASE) >> PAGESHIFT;
     for (int i = data_pg1; i < data_pg1 + data_npg; i++) {
+        if (i >= bss_pg1) {
+            map_zero_page(proc, i);
+            continue;
+        }
         int nf = allocate_frame();
         if (nf == ERROR) {
             TracePrintf(1, "ERROR, no new frames to allocate for LoadProgram.\n");
-            return ERROR;
+            // The old address space is already gone, so the caller has to kill the process
+            close(fd);
+            free(argbuf);
+            return KILL;
         }
         proc->region1_pt[i].valid = 1;                      // CORRECT: Modifies the actual page table entry
         proc->region1_pt[i].prot = PROT_READ | PROT_WRITE;  // CORRECT: Modifies the actual page table entry
         proc->region1_pt[i].pfn = nf;                       // CORRECT: Modifies the actual page table entry
+        frame_set_owner(nf, proc, i);
+        swap_pin(proc, i);
     }
     
-    proc->brk = (void *)((data_pg1 + data_npg) << PAGESHIFT);
+    proc->cold->brk = (void *)((data_pg1 + data_npg) << PAGESHIFT);
+    proc->cold->heap_base = proc->cold->brk;
 
     /*
      * ==>> Then, stack. Allocate "stack_npg" physical pages and map them to the top
@@ -223,14 +243,20 @@ int LoadProgram(char *name, char *args[], pcb_t *proc) {
 
     TracePrintf(1, "Load_program: Allocating pages for stack.\n");
     for (int i = MAX_PT_LEN - stack_npg; i < MAX_PT_LEN; i++) {
-        int nf = allocate_frame();
+        // Zeroed so nothing from the frame's last owner shows up below the arguments
+        int nf = allocate_zeroed_frame();
         if (nf == ERROR) {
             TracePrintf(1, "ERROR, no new frames to allocate for LoadProgram.\n");
-            return ERROR;
+            // The old address space is already gone, so the caller has to kill the process
+            close(fd);
+            free(argbuf);
+            return KILL;
         }
         proc->region1_pt[i].valid = 1;                      // CORRECT: Modifies the actual page table entry
         proc->region1_pt[i].prot = PROT_READ | PROT_WRITE;  // CORRECT: Modifies the actual page table entry
         proc->region1_pt[i].pfn = nf;                       // CORRECT: Modifies the actual page table entry
+        frame_set_owner(nf, proc, i);
+        swap_pin(proc, i);
     }
 
     /*
@@ -251,6 +277,7 @@ int LoadProgram(char *name, char *args[], pcb_t *proc) {
     if (read(fd, (void *)li.t_vaddr, segment_size) != segment_size) {
         TracePrintf(0, "Load_program. ERROR failed to do whatever read is supposed to do");
         close(fd);
+        free(argbuf);
         return KILL;  // see ykernel.h
     }
 
@@ -263,6 +290,7 @@ int LoadProgram(char *name, char *args[], pcb_t *proc) {
 
     if (read(fd, (void *)li.id_vaddr, segment_size) != segment_size) {
         close(fd);
+        free(argbuf);
         return KILL;
     }
 
@@ -287,10 +315,11 @@ int LoadProgram(char *name, char *args[], pcb_t *proc) {
     }
 
     /*
-     * Zero out the uninitialized data area
+     * Zero out the uninitialized data area, only the part sharing a page
+     * with initialized data needs it since the rest is on the zero page
      */
-    bzero((void *)li.id_end, li.ud_end - li.id_end);
-    bzero((void *)li.id_end, li.ud_end - li.id_end);
+    unsigned int bss_split = UP_TO_PAGE(li.id_end) < li.ud_end ? UP_TO_PAGE(li.id_end) : li.ud_end;
+    bzero((void *)li.id_end, bss_split - li.id_end);
 
     /*
      * Set the entry point in the process's UserContext
@@ -300,7 +329,7 @@ int LoadProgram(char *name, char *args[], pcb_t *proc) {
      * ==>> (rewrite the line below to match your actual data structure)
      * ==>> proc->uc.pc = (caddr_t) li.entry;
      */
-    proc->user_context.pc = (caddr_t)li.entry;
+    proc->cold->user_context.pc = (caddr_t)li.entry;
 
     /*
      * Now, finally, build the argument list on the new stack.
@@ -5,6 +5,9 @@
  */
 
 #include "memory.h"
+#include "mmap.h"
+#include "swap.h"
+#include "shm.h"
 #include <hardware.h>
 #include <yalnix.h>
 
@@ -15,8 +18,21 @@ void *kernel_brk = NULL;  // Current kernel break address
 void *user_brk = NULL;    // Current user break address
 pte_t region0_pt[MAX_PT_LEN]; // Page table for Region 0
 
+// One entry per page of the kernel mapping window
+typedef struct kmap_slot {
+    int pfn;                // Frame currently mapped in the slot, or -1
+    int pins;               // Outstanding kmap_frame calls using the slot
+    unsigned int last_use;  // kmap_clock value of the last kmap_frame, for LRU
+} kmap_slot_t;
+
+static kmap_slot_t kmap_slots[KMAP_SLOTS] = { [0 ... KMAP_SLOTS - 1] = { -1, 0, 0 } };
+static unsigned int kmap_clock = 0;
+
+unsigned int uctxt_copy_bytes = 0;
+
 void cpyuc(UserContext *dest, UserContext *src){
     memcpy(dest, src, sizeof(UserContext));
+    uctxt_copy_bytes += sizeof(UserContext);
 }
 
 int SetKernelBrk(void *addr) {
@@ -29,7 +45,7 @@ int SetKernelBrk(void *addr) {
 
     // Calculate page numbers for the heap boundaries
     unsigned int first_kernel_data_page_num = ADDR_TO_PAGE_NUM(_first_kernel_data_page);
-    unsigned int kernel_heap_max_page_num = ADDR_TO_PAGE_NUM(KERNEL_STACK_BASE);
+    unsigned int kernel_heap_max_page_num = ADDR_TO_PAGE_NUM(KMAP_BASE_VADDR);  // The mapping window sits between the heap and the stack
 
     // Validate the requested address: Must be within Region 0 and not conflict with stack.
     if (new_brk_page < first_kernel_data_page_num) {
@@ -141,9 +157,11 @@ void init_region0_pageTable(int kernel_text_start, int kernel_data_start, int ke
     // Dynamically allocate frame_bitMap based on the actual physical memory size.
     unsigned int num_physical_frames = pmem_size / PAGESIZE;
     frame_bitMap = (int *)calloc(num_physical_frames, sizeof(int)); // Use calloc to zero-initialize the bitmap
-    if (frame_bitMap == NULL) {
+    frame_owners = (frame_owner_t *)calloc(num_physical_frames, sizeof(frame_owner_t));
+    if (frame_bitMap == NULL || frame_owners == NULL) {
         TracePrintf(0, "ERROR: Failed to allocate frame_bitMap\n");
     }
+    frame_count = num_physical_frames;
     frame_bitMap[0] = 1;
 
     // Initialize mappings for kernel text, data, and heap sections in the Region 0 page table.
@@ -221,7 +239,8 @@ pte_t *InitializeKernelStack(void){
     if(vm_enabled == 1){
         for (int vpn = 0; vpn < KERNEL_STACK_MAXSIZE >> PAGESHIFT; vpn++){
             // kernel stack only has 2 entries!!!!!!!
-            int pfn = allocate_frame();
+            // Zeroed, KCCopy only fills in the part of the stack that is live
+            int pfn = allocate_zeroed_frame();
             if(pfn == ERROR){
                 TracePrintf(0, "ERROR failed to allocate a frame");
                 Halt();
@@ -246,6 +265,171 @@ void map_page(pte_t *page_table_base, int vpn, int pfn, int prot) {
 
 
 
+int find_free_range(pcb_t *proc, int npages) {
+    int floor = (unsigned int)proc->cold->brk >> PAGESHIFT;
+    int top = (DOWN_TO_PAGE(proc->cold->user_context.sp) - VMEM_1_BASE) >> PAGESHIFT;
+    int run = 0;
+    for (int i = top - STACK_GAP_PAGES - 1; i >= floor; i--) {
+        // File mappings reserve their pages before they are read in
+        bool used = proc->region1_pt[i].valid || mmap_find(proc, i) != NULL || swap_holds(proc, i);
+        run = used ? 0 : run + 1;
+        if (run == npages) return i;
+    }
+    TracePrintf(1, "find_free_range: no room for %d pages in process %d\n", npages, proc->pid);
+    return ERROR;
+}
+
+
+int lowest_mapping_page(pcb_t *proc) {
+    int lowest = MAX_PT_LEN;
+    for (list_node_t *node = proc->cold->shm_maps.head.next; node != &proc->cold->shm_maps.head; node = node->next) {
+        if (shm_map_from_node(node)->vpn < lowest) lowest = shm_map_from_node(node)->vpn;
+    }
+    for (list_node_t *node = proc->cold->mmap_regions.head.next; node != &proc->cold->mmap_regions.head; node = node->next) {
+        if (mmap_from_node(node)->vpn < lowest) lowest = mmap_from_node(node)->vpn;
+    }
+    return lowest;
+}
+
+
+int heap_fault(int vpn) {
+    pcb_t *proc = current_process;
+    int base = (unsigned int)proc->cold->heap_base >> PAGESHIFT;
+    int brk = (unsigned int)proc->cold->brk >> PAGESHIFT;
+    if (vpn < base || vpn >= brk || proc->region1_pt[vpn].valid || swap_holds(proc, vpn)) return ERROR;
+
+    int pfn = allocate_zeroed_frame();
+    if (pfn == ERROR) {
+        TracePrintf(0, "heap_fault: ERROR: No frame for heap page %d of process %d\n", vpn, proc->pid);
+        return ERROR;
+    }
+    proc->region1_pt[vpn].pfn = pfn;
+    proc->region1_pt[vpn].prot = PROT_READ | PROT_WRITE;
+    proc->region1_pt[vpn].valid = 1;
+    frame_set_owner(pfn, proc, vpn);
+    proc->cold->minor_faults++;
+    WriteRegister(REG_TLB_FLUSH, VMEM_1_BASE + (vpn << PAGESHIFT));
+    return 0;
+}
+
+
+void map_zero_page(pcb_t *proc, int vpn) {
+    frame_ref(zero_pfn);
+    proc->region1_pt[vpn].pfn = zero_pfn;
+    proc->region1_pt[vpn].prot = PROT_READ;
+    proc->region1_pt[vpn].valid = 1;
+    proc->cold->page_meta[vpn].cow = true;
+}
+
+
+int cow_break(pcb_t *proc, int vpn) {
+    if (!proc->cold->page_meta[vpn].cow) return ERROR;
+    // The shared page only ever holds zeros, so a zeroed frame is already the copy
+    int pfn = allocate_zeroed_frame();
+    if (pfn == ERROR) {
+        TracePrintf(0, "cow_break: ERROR: No frame for page %d of process %d\n", vpn, proc->pid);
+        return ERROR;
+    }
+    free_frame(zero_pfn);
+    proc->region1_pt[vpn].pfn = pfn;
+    proc->region1_pt[vpn].prot = PROT_READ | PROT_WRITE;
+    proc->cold->page_meta[vpn].cow = false;
+    frame_set_owner(pfn, proc, vpn);
+    proc->cold->cow_breaks++;
+    if (proc == current_process) WriteRegister(REG_TLB_FLUSH, VMEM_1_BASE + (vpn << PAGESHIFT));
+    return 0;
+}
+
+
+int user_buffer_ready(void *addr, int len, bool write) {
+    unsigned int start = (unsigned int)addr;
+    if (len < 0 || start < VMEM_1_BASE || start + len > VMEM_1_LIMIT || start + len < start) {
+        TracePrintf(1, "user_buffer_ready: buffer %p of %d bytes is not in Region 1\n", addr, len);
+        return ERROR;
+    }
+    if (len == 0) return 0;
+
+    pcb_t *proc = current_process;
+    int first = (start - VMEM_1_BASE) >> PAGESHIFT;
+    int last = (start + len - 1 - VMEM_1_BASE) >> PAGESHIFT;
+    for (int vpn = first; vpn <= last; vpn++) {
+        if (swap_holds(proc, vpn)) swap_settle(proc, vpn);
+        else if (!proc->region1_pt[vpn].valid && heap_fault(vpn) == ERROR) mmap_fault(vpn);
+
+        pte_t *entry = &proc->region1_pt[vpn];
+        if (!entry->valid) return ERROR;
+        swap_pin(proc, vpn);
+        if (write && proc->cold->page_meta[vpn].cow && cow_break(proc, vpn) == ERROR) return ERROR;
+        if (write ? !(entry->prot & PROT_WRITE) : !(entry->prot & PROT_READ)) return ERROR;
+    }
+    return 0;
+}
+
+
+int user_string_ready(char *str) {
+    unsigned int addr = (unsigned int)str;
+    while (1) {
+        // One page at a time, the page after the terminator may not be mapped at all
+        int chunk = PAGESIZE - (addr & PAGEOFFSET);
+        if (user_buffer_ready((void *)addr, chunk, false) == ERROR) return ERROR;
+        for (char *c = (char *)addr; c < (char *)addr + chunk; c++) {
+            if (*c == '\0') return c - str;
+        }
+        addr += chunk;
+    }
+}
+
+
+int user_argv_ready(char **argv) {
+    for (int i = 0; ; i++) {
+        if (user_buffer_ready(&argv[i], sizeof(char *), false) == ERROR) return ERROR;
+        if (argv[i] == NULL) return i;
+        if (user_string_ready(argv[i]) == ERROR) return ERROR;
+    }
+}
+
+
+void *kmap_frame(int pfn) {
+    int victim = -1;
+    for (int i = 0; i < KMAP_SLOTS; i++) {
+        if (kmap_slots[i].pfn == pfn) {
+            victim = i;
+            break;
+        }
+        if (kmap_slots[i].pins == 0 && (victim < 0 || kmap_slots[i].last_use < kmap_slots[victim].last_use)) victim = i;
+    }
+    if (victim < 0) {
+        // Every caller holds at most a couple of slots at once, so this means a kunmap_frame is missing
+        TracePrintf(0, "kmap_frame: ERROR: all %d mapping window slots are pinned, halting.\n", KMAP_SLOTS);
+        Halt();
+    }
+
+    kmap_slot_t *slot = &kmap_slots[victim];
+    unsigned int vaddr = KMAP_BASE_VADDR + victim * PAGESIZE;
+    if (slot->pfn != pfn) {
+        int vpn = vaddr >> PAGESHIFT;
+        region0_pt[vpn].valid = 1;
+        region0_pt[vpn].pfn = pfn;
+        region0_pt[vpn].prot = PROT_READ | PROT_WRITE;
+        WriteRegister(REG_TLB_FLUSH, vaddr);
+        slot->pfn = pfn;
+    }
+    slot->pins++;
+    slot->last_use = ++kmap_clock;
+    return (void *)vaddr;
+}
+
+
+void kunmap_frame(void *addr) {
+    int i = ((unsigned int)addr - KMAP_BASE_VADDR) >> PAGESHIFT;
+    if (i < 0 || i >= KMAP_SLOTS || kmap_slots[i].pins == 0) {
+        TracePrintf(0, "kunmap_frame: ERROR: %p is not a pinned mapping window address\n", addr);
+        return;
+    }
+    kmap_slots[i].pins--;
+}
+
+
 void unmap_page(pte_t *page_table_base, int vpn) {
     pte_t *entry = page_table_base + vpn;
     // Invalidate the page table entry by setting the valid bit to 0.
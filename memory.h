@@ -15,6 +15,11 @@ extern int vm_enabled;  // Flag indicating if virtual memory is enabled
 extern void *kernel_brk;  // Current kernel break address
 extern void *user_brk;    // Current user break address
 extern pte_t region0_pt[]; // Page table for Region 0
+extern unsigned int uctxt_copy_bytes;  // Bytes of UserContext moved by cpyuc, reported by SwitchStats
+
+// Region 0 pages reserved just under the kernel stack for kmap_frame
+#define KMAP_SLOTS 8
+#define KMAP_BASE_VADDR (KERNEL_STACK_BASE - KMAP_SLOTS * PAGESIZE)
 
 #define ADDR_TO_PAGE_NUM(addr) ((unsigned int)(addr) >> PAGESHIFT)
 #define PAGE_NUM_TO_ADDR(page_num) ((void *)((unsigned int)(page_num) << PAGESHIFT))
@@ -77,6 +82,29 @@ pte_t *InitializeKernelStack(void);
 void map_page(pte_t *page_table_base, int vpn, int pfn, int prot);
 
 
+/**
+ * @brief Maps a physical frame into the kernel's mapping window.
+ *
+ * The window is KMAP_SLOTS Region 0 pages. A frame that is still mapped in a
+ * slot is reused as is, otherwise the least recently used unpinned slot is
+ * remapped, so only a miss costs a PTE write and a TLB flush. The slot stays
+ * pinned until kunmap_frame.
+ *
+ * @param pfn The physical frame number to map.
+ * @return The kernel virtual address of the frame. Halts if every slot is pinned,
+ *         since that only happens when a kunmap_frame is missing.
+ */
+void *kmap_frame(int pfn);
+
+
+/**
+ * @brief Unpins a slot from kmap_frame, the mapping is kept for reuse.
+ *
+ * @param addr The address kmap_frame returned.
+ */
+void kunmap_frame(void *addr);
+
+
 /**
  * @brief Unmaps a virtual page from a given page table.
  *
@@ -88,4 +116,100 @@ void map_page(pte_t *page_table_base, int vpn, int pfn, int prot);
  */
 void unmap_page(pte_t *page_table_base, int vpn);
 
+
+// Pages kept free below the stack pointer so the stack can still grow
+#define STACK_GAP_PAGES 8
+
+/**
+ * @brief Finds a run of unmapped Region 1 pages to place a new mapping in.
+ *
+ * Searches down from STACK_GAP_PAGES below the stack pointer and stops at the
+ * break, so mappings land as high as possible and away from the heap.
+ *
+ * @param proc The process whose Region 1 is searched.
+ * @param npages The number of consecutive pages needed.
+ * @return The first page number of the run, or ERROR if there is no room.
+ */
+int find_free_range(pcb_t *proc, int npages);
+
+
+/**
+ * @brief Finds the lowest Region 1 page used by a shared segment or file mapping.
+ *
+ * The heap may grow up to this page but not into it.
+ *
+ * @param proc The process to check.
+ * @return The page number, or MAX_PT_LEN if proc has no mappings.
+ */
+int lowest_mapping_page(pcb_t *proc);
+
+
+/**
+ * @brief Gives a heap page of the current process a zeroed frame on its first touch.
+ *
+ * Brk only moves the limit, so pages in [heap_base, brk) are mapped here.
+ *
+ * @param vpn The Region 1 page that faulted.
+ * @return 0 if the page is now mapped, ERROR if it is not an unmapped heap page.
+ */
+int heap_fault(int vpn);
+
+
+/**
+ * @brief Maps a Region 1 page to the shared zero page, copy on write.
+ *
+ * The page reads as zeros and gets a private frame the first time it is written.
+ *
+ * @param proc The process to map the page in.
+ * @param vpn The Region 1 page number.
+ */
+void map_zero_page(pcb_t *proc, int vpn);
+
+
+/**
+ * @brief Gives a copy on write page its own zeroed, writable frame.
+ *
+ * @param proc The process that owns the page.
+ * @param vpn The Region 1 page number.
+ * @return 0 on success, ERROR if the page is not copy on write or no frame is left.
+ */
+int cow_break(pcb_t *proc, int vpn);
+
+
+/**
+ * @brief Makes a user buffer of the current process safe for the kernel to touch.
+ *
+ * Kernel accesses to Region 1 must not fault, so any page the pager is
+ * holding or a file mapping has not read in yet is brought in first, and
+ * copy on write pages are broken when the kernel is going to write. The
+ * pages stay pinned until the trap ends.
+ *
+ * @param addr Start of the buffer.
+ * @param len Length of the buffer in bytes.
+ * @param write True if the kernel will write to the buffer.
+ * @return 0 if every page is mapped with the needed access, ERROR otherwise.
+ */
+int user_buffer_ready(void *addr, int len, bool write);
+
+
+/**
+ * @brief Makes a NUL terminated user string safe for the kernel to read.
+ *
+ * Pages are readied one at a time up to the page holding the terminator,
+ * so a string that ends right before an unmapped page is still accepted.
+ *
+ * @param str Start of the string.
+ * @return The length of the string, ERROR if it runs into a page that cannot be read.
+ */
+int user_string_ready(char *str);
+
+
+/**
+ * @brief Makes a NULL terminated user array of strings, like Exec's argvec, safe to read.
+ *
+ * @param argv Start of the array.
+ * @return The number of strings before the NULL, ERROR if any part cannot be read.
+ */
+int user_argv_ready(char **argv);
+
 #endif /* _MEMORY_H_ */
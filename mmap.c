@@ -0,0 +1,176 @@
+/**
+ * Date: 5/22/25
+ * File: mmap.c
+ * Description: Host file mapping implementation for Yalnix OS
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <yalnix.h>
+#include <ykernel.h>
+
+#include "mmap.h"
+#include "memory.h"
+#include "frames.h"
+#include "ext_syscalls.h"
+#include "swap.h"
+
+static void mmap_unmap(pcb_t *proc, mmap_region_t *region);
+
+int mmap_create(mmap_args_t *args){
+    TracePrintf(1, "Enter mmap_create.\n");
+    pcb_t *curr = current_process;
+    int npages = UP_TO_PAGE(args->len) >> PAGESHIFT;
+    if(args->len <= 0 || npages > MMAP_MAX_PAGES || args->offset < 0 || (args->offset & PAGEOFFSET) != 0){
+        TracePrintf(1, "ERROR, cannot map %d bytes at file offset %d.\n", args->len, args->offset);
+        return ERROR;
+    }
+    if((args->prot & ~(PROT_READ | PROT_WRITE | PROT_EXEC)) != 0 || (args->flags & ~MMAP_WRITEBACK) != 0){
+        TracePrintf(1, "ERROR, bad protection %x or flags %x for a mapping.\n", args->prot, args->flags);
+        return ERROR;
+    }
+
+    // Only open the file for writing when changes will actually be written back
+    bool writeback = (args->flags & MMAP_WRITEBACK) && (args->prot & PROT_WRITE);
+    int fd = open(args->path, writeback ? O_RDWR : O_RDONLY);
+    if(fd < 0){
+        TracePrintf(1, "ERROR, could not open host file '%s' for mapping.\n", args->path);
+        return ERROR;
+    }
+
+    int vpn = find_free_range(curr, npages);
+    mmap_region_t *region = (vpn == ERROR) ? NULL : (mmap_region_t *)malloc(sizeof(mmap_region_t));
+    if(region == NULL){
+        TracePrintf(1, "ERROR, no room to map '%s' in process %d.\n", args->path, curr->pid);
+        close(fd);
+        return ERROR;
+    }
+    region->vpn = vpn;
+    region->npages = npages;
+    region->fd = fd;
+    region->offset = args->offset;
+    region->len = args->len;
+    region->prot = args->prot;
+    region->flags = writeback ? MMAP_WRITEBACK : 0;
+    insert_tail(&curr->cold->mmap_regions, &region->node);
+
+    args->addr = (void *)(VMEM_1_BASE + (vpn << PAGESHIFT));
+    TracePrintf(1, "Exit mmap_create, '%s' reserved at %p for %d pages.\n", args->path, args->addr, npages);
+    return SUCCESS;
+}
+
+int mmap_remove(void *addr){
+    TracePrintf(1, "Enter mmap_remove.\n");
+    pcb_t *curr = current_process;
+    int vpn = ((unsigned int)addr - VMEM_1_BASE) >> PAGESHIFT;
+    mmap_region_t *region = mmap_find(curr, vpn);
+    if(region == NULL || region->vpn != vpn || ((unsigned int)addr & PAGEOFFSET) != 0){
+        TracePrintf(1, "ERROR, no mapping starts at %p.\n", addr);
+        return ERROR;
+    }
+    list_remove(&curr->cold->mmap_regions, &region->node);
+    mmap_unmap(curr, region);
+    TracePrintf(1, "Exit mmap_remove.\n");
+    return SUCCESS;
+}
+
+mmap_region_t *mmap_find(pcb_t *proc, int vpn){
+    list_node_t *node = proc->cold->mmap_regions.head.next;
+    while(node != &proc->cold->mmap_regions.head){
+        mmap_region_t *region = mmap_from_node(node);
+        if(vpn >= region->vpn && vpn < region->vpn + region->npages) return region;
+        node = node->next;
+    }
+    return NULL;
+}
+
+int mmap_fault(int vpn){
+    pcb_t *curr = current_process;
+    mmap_region_t *region = mmap_find(curr, vpn);
+    if(region == NULL || curr->region1_pt[vpn].valid) return ERROR;
+
+    int pfn = allocate_zeroed_frame();
+    if(pfn == ERROR){
+        TracePrintf(1, "ERROR, no frame to read in page %d of a mapping.\n", vpn);
+        return ERROR;
+    }
+
+    // Fill the frame through the mapping window, the tail past the file stays zeroed
+    int page_off = (vpn - region->vpn) << PAGESHIFT;
+    int want = region->len - page_off < PAGESIZE ? region->len - page_off : PAGESIZE;
+    void *page = kmap_frame(pfn);
+    lseek(region->fd, region->offset + page_off, SEEK_SET);
+    int got = read(region->fd, page, want);
+    kunmap_frame(page);
+    if(got < 0){
+        TracePrintf(1, "ERROR, reading page %d of a mapping from the host file failed.\n", vpn);
+        free_frame(pfn);
+        return ERROR;
+    }
+
+    curr->region1_pt[vpn].pfn = pfn;
+    curr->region1_pt[vpn].prot = region->prot;
+    curr->region1_pt[vpn].valid = 1;
+    frame_set_owner(pfn, curr, vpn);
+    curr->cold->major_faults++;
+    WriteRegister(REG_TLB_FLUSH, VMEM_1_BASE + (vpn << PAGESHIFT));
+    TracePrintf(1, "mmap_fault: read %d bytes into page %d of process %d.\n", got, vpn, curr->pid);
+    return SUCCESS;
+}
+
+int mmap_copy_regions(pcb_t *parent, pcb_t *child){
+    list_node_t *node = parent->cold->mmap_regions.head.next;
+    while(node != &parent->cold->mmap_regions.head){
+        mmap_region_t *region = mmap_from_node(node);
+        mmap_region_t *copy = (mmap_region_t *)malloc(sizeof(mmap_region_t));
+        if(copy == NULL){
+            TracePrintf(1, "ERROR, could not copy the mappings of process %d.\n", parent->pid);
+            return ERROR;
+        }
+        *copy = *region;
+        // The child closes its descriptor on its own schedule
+        copy->fd = dup(region->fd);
+        insert_tail(&child->cold->mmap_regions, &copy->node);
+        node = node->next;
+    }
+    return SUCCESS;
+}
+
+void mmap_release_regions(pcb_t *proc){
+    while(!list_is_empty(&proc->cold->mmap_regions)){
+        mmap_unmap(proc, mmap_from_node(pop(&proc->cold->mmap_regions)));
+    }
+}
+
+// Writes back the resident pages if requested, then frees them and the region
+static void mmap_unmap(pcb_t *proc, mmap_region_t *region){
+    for(int i = 0; i < region->npages; i++){
+        pte_t *entry = &proc->region1_pt[region->vpn + i];
+        // Paged out pages are only worth reading back if they are going to be written out
+        if(swap_holds(proc, region->vpn + i)){
+            if(region->flags & MMAP_WRITEBACK) swap_settle(proc, region->vpn + i);
+            else swap_discard(proc, region->vpn + i);
+        }
+        if(!entry->valid) continue;
+
+        if(region->flags & MMAP_WRITEBACK){
+            // proc may not be current, so go through the frame rather than its address
+            int page_off = i << PAGESHIFT;
+            int count = region->len - page_off < PAGESIZE ? region->len - page_off : PAGESIZE;
+            void *page = kmap_frame(entry->pfn);
+            lseek(region->fd, region->offset + page_off, SEEK_SET);
+            if(write(region->fd, page, count) != count){
+                TracePrintf(1, "ERROR, writing back page %d of a mapping failed.\n", region->vpn + i);
+            }
+            kunmap_frame(page);
+        }
+
+        free_frame(entry->pfn);
+        entry->valid = 0;
+        entry->prot = 0;
+        entry->pfn = 0;
+        if(proc == current_process) WriteRegister(REG_TLB_FLUSH, VMEM_1_BASE + ((region->vpn + i) << PAGESHIFT));
+    }
+    close(region->fd);
+    free(region);
+}
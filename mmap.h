@@ -0,0 +1,77 @@
+/**
+ * Date: 5/22/25
+ * File: mmap.h
+ * Description: Host file mappings for Yalnix OS
+ */
+
+#ifndef _MMAP_H_
+#define _MMAP_H_
+
+#include <hardware.h>
+#include "pcb.h"
+#include "ext_syscalls.h"
+
+// Largest file mapping, in pages
+#define MMAP_MAX_PAGES 256
+
+// A host file mapped into part of a process's Region 1, pages are read in on first touch
+typedef struct mmap_region {
+    list_node_t node;  // Node in the process's mmap_regions list
+    int vpn;           // First Region 1 page of the mapping
+    int npages;        // Number of pages reserved for the mapping
+    int fd;            // Host file descriptor the pages are read from
+    int offset;        // File offset of the first page
+    int len;           // Bytes of the file that are mapped
+    int prot;          // Protection of the pages once they are read in
+    int flags;         // MMAP_WRITEBACK
+} mmap_region_t;
+
+#define mmap_from_node(ptr) container_of(ptr, mmap_region_t, node)
+
+/**
+ * Reserve pages for a host file in the current process, nothing is read yet
+ *
+ * @param args Path, offset, length, protection and flags of the mapping,
+ *             the chosen address is written back to args->addr
+ * @return SUCCESS, or ERROR on bad arguments, an unopenable file or no room
+ */
+int mmap_create(mmap_args_t *args);
+
+/**
+ * Remove the mapping that starts at addr, writing it back first if requested
+ *
+ * @param addr Address returned by Mmap
+ * @return SUCCESS, or ERROR if no mapping starts at addr
+ */
+int mmap_remove(void *addr);
+
+/**
+ * Find the mapping of proc that covers a Region 1 page
+ *
+ * @return The mapping, or NULL if the page is not file backed
+ */
+mmap_region_t *mmap_find(pcb_t *proc, int vpn);
+
+/**
+ * Read in a faulted page of a file mapping of the current process
+ *
+ * @param vpn Region 1 page that faulted
+ * @return SUCCESS if the page is now mapped, ERROR if it is not file backed
+ */
+int mmap_fault(int vpn);
+
+/**
+ * Give child its own descriptors for each of parent's mappings, used by Fork
+ *
+ * @return SUCCESS, or ERROR if a mapping could not be copied
+ */
+int mmap_copy_regions(pcb_t *parent, pcb_t *child);
+
+/**
+ * Write back and drop all of proc's mappings, used when its user space is torn down
+ *
+ * @param proc Process whose user space is being torn down
+ */
+void mmap_release_regions(pcb_t *proc);
+
+#endif /* _MMAP_H_ */
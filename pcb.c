@@ -6,6 +6,11 @@
 #include <ykernel.h>
 #include "pcb.h"
 #include "frames.h"
+#include "shm.h"
+#include "mmap.h"
+#include "swap.h"
+#include "sched.h"
+#include "sync.h"
 
 /* -------------------------------------------------------------- Define Global Variables -------------------------------------------------- */
 pcb_t *current_process = NULL;
@@ -14,6 +19,7 @@ list_t *ready_queue;
 list_t *delay_queue;
 list_t *blocked_queue;
 list_t *zombie_queue;
+list_t *timeout_queue;
 
 int init_pcb_system(void) {
     TracePrintf(1, "ENTER init_pcb_system.\n");
@@ -21,9 +27,10 @@ int init_pcb_system(void) {
     delay_queue = create_list();
     blocked_queue = create_list();
     zombie_queue = create_list();
+    timeout_queue = create_list();
 
     // If any of the queues failed to initialize return Error, else return 0
-    if(ready_queue == NULL || delay_queue  == NULL || zombie_queue  == NULL || blocked_queue == NULL) {
+    if(ready_queue == NULL || delay_queue  == NULL || zombie_queue  == NULL || blocked_queue == NULL || timeout_queue == NULL) {
         TracePrintf(1, "ERROR, The kernel has failed to allocate a pcb queue.\n");
         return ERROR;
     }
@@ -39,6 +46,14 @@ pcb_t *create_pcb(void) {
         TracePrintf(1, "ERROR, The kernel has failed to allocate the pcb.\n");
         return NULL;
     } // If it failed return NULL
+    // Zeroed, init's saved UserContext only ever gets its pc and sp filled in
+    new_pcb->cold = calloc(1, sizeof(pcb_cold_t));
+    if (new_pcb->cold == NULL) {
+        TracePrintf(1, "ERROR, The kernel has failed to allocate the cold part of the pcb.\n");
+        free(new_pcb);
+        return NULL;
+    }
+    new_pcb->cold->proc = new_pcb;
     
     // Assign unique PID
     new_pcb->pid = 0;
@@ -49,47 +64,90 @@ pcb_t *create_pcb(void) {
     // Zero out timers, exit code
     new_pcb->time_slice = DEFAULT_TIMESLICE;
     new_pcb->run_time = 0;
+    new_pcb->base_priority = DEFAULT_PRIORITY;
+    new_pcb->priority = DEFAULT_PRIORITY;
     new_pcb->delay_ticks = 0;
-    new_pcb->exit_code = 0;
+    new_pcb->handoff = NULL;
+    new_pcb->tickets = SCHED_DEFAULT_TICKETS;
+    new_pcb->lent_tickets = 0;
+    new_pcb->stride = STRIDE1 / SCHED_DEFAULT_TICKETS;
+    new_pcb->pass = 0;
+    new_pcb->pass_remain = 0;
+    new_pcb->rt = false;
+    new_pcb->rt_throttled = false;
+    new_pcb->rt_period = 0;
+    new_pcb->rt_budget = 0;
+    new_pcb->rt_used = 0;
+    new_pcb->rt_deadline = 0;
+    new_pcb->cold->exit_code = 0;
 
     // Relationships
-    new_pcb->parent = NULL;
-    list_init(&new_pcb->children);
-    new_pcb->waiting_for_children = 0;
+    new_pcb->cold->parent = NULL;
+    list_init(&new_pcb->cold->children);
+    new_pcb->cold->waiting_for_children = 0;
+    new_pcb->cold->child_status = 0;
 
     // Initialize region 1 page table as invalid
     new_pcb->region1_pt = (pte_t *)calloc(MAX_PT_LEN, sizeof(pte_t));
+    list_init(&new_pcb->cold->shm_maps);
+    list_init(&new_pcb->cold->mmap_regions);
+    new_pcb->cold->page_meta = (page_meta_t *)calloc(MAX_PT_LEN, sizeof(page_meta_t));
+    for (int i = 0; new_pcb->cold->page_meta != NULL && i < MAX_PT_LEN; i++) {
+        new_pcb->cold->page_meta[i].swap_slot = NO_SWAP_SLOT;
+    }
+    new_pcb->cold->minor_faults = 0;
+    new_pcb->cold->major_faults = 0;
+    new_pcb->cold->cow_breaks = 0;
+    new_pcb->cold->working_set = 0;
     
     // Assign a pid to the process
     new_pcb->pid = helper_new_pid(new_pcb->region1_pt);
  
     // All of these start unitialized
-    new_pcb->brk = NULL;
+    new_pcb->cold->heap_base = NULL;
+    new_pcb->cold->brk = NULL;
     
-    new_pcb->tty_read_buffer = NULL;
-    new_pcb->tty_read_len = 0;
-    new_pcb->tty_read_terminal = -1;
-
-    new_pcb->tty_write_buffer = NULL;
-    new_pcb->tty_write_len = 0;
-    new_pcb->tty_write_terminal = -1;
-    new_pcb->tty_write_offset = 0;
-
-    new_pcb->waiting_lock_id = -1;
-    new_pcb->waiting_cvar_id = -1;
-    new_pcb->waiting_pipe_id = -1;
-
-    new_pcb->pipe_buffer = NULL;
-    new_pcb->pipe_len = 0;
-    new_pcb->write_loc = 0;
-
-    new_pcb->should_fork = true;
+    new_pcb->cold->tty_read_buffer = NULL;
+    new_pcb->cold->tty_read_len = 0;
+    new_pcb->cold->tty_read_terminal = -1;
+
+    new_pcb->cold->tty_write_buffer = NULL;
+    new_pcb->cold->tty_write_len = 0;
+    new_pcb->cold->tty_write_terminal = -1;
+    new_pcb->cold->tty_write_offset = 0;
+
+    new_pcb->cold->waiting_lock_id = -1;
+    new_pcb->cold->waiting_cvar_id = -1;
+    new_pcb->cold->cvar_lock_id = -1;
+    new_pcb->cold->waiting_pipe_id = -1;
+    list_init(&new_pcb->cold->held_locks);
+    list_init(&new_pcb->cold->rw_holds);
+    new_pcb->cold->rw_write = false;
+    new_pcb->cold->sem_wanted = 0;
+    new_pcb->cold->futex_key = 0;
+    new_pcb->cold->futex_vpn = 0;
+    new_pcb->timeout_ticks = 0;
+    new_pcb->wait_list = NULL;
+    new_pcb->timed_out = false;
+    new_pcb->polling = false;
+
+    new_pcb->cold->pipe_buffer = NULL;
+    new_pcb->cold->pipe_len = 0;
+    new_pcb->cold->write_loc = 0;
+
+    new_pcb->cold->should_fork = true;
 
     TracePrintf(1, "EXIT create_pcb.\n");
     return new_pcb;
 }
 
 
+void free_pcb(pcb_t *process) {
+    free(process->cold);
+    free(process);
+}
+
+
 // FOR ANY add_to_{}_queue CALL MAKE SURE THE PROCESS IS EITHER (1) NEW or (2)HAD REMOVE_FROM_{}_QUEUE CALLED ON IT
 // The pcb must have it's state set to default for it to work
 void add_to_ready_queue(pcb_t *process) {
@@ -103,12 +161,55 @@ void add_to_ready_queue(pcb_t *process) {
         return;
     };
 
+    // Woken before its timed wait ran out, so stop the clock
+    if(process->wait_list != NULL) remove_from_timeout_queue(process);
+
+    // The running process is only being requeued, anyone else is joining from a wait or from Fork
+    if(process != current_process && !process->rt) sched->on_wake(process);
     process->state = PROCESS_READY;
-    insert_tail(ready_queue, &process->queue_node);
+    sched_enqueue(process);
     TracePrintf(1, "There are now %d processes in the ready queue.\n", ready_queue->count);
     TracePrintf(1, "EXIT add_to_ready_queue.\n");
 }
 
+void insert_by_priority(list_t *list, pcb_t *process) {
+    // Walk back from the tail so equal priorities stay FIFO and the common case is O(1)
+    list_node_t *head = &list->head;
+    list_node_t *curr = head->prev;
+    while(curr != head && pcb_from_queue_node(curr)->priority < process->priority){
+        curr = curr->prev;
+    }
+
+    // Link the process in right after curr
+    list_node_t *node = &process->queue_node;
+    node->prev = curr;
+    node->next = curr->next;
+    curr->next->prev = node;
+    curr->next = node;
+    list->count ++;
+}
+
+void set_effective_priority(pcb_t *process, int priority) {
+    TracePrintf(1, "ENTER set_effective_priority.\n");
+    if(process == NULL){
+        TracePrintf(1, "ERROR, process was not an initialized pcb.\n");
+        return;
+    }
+    if(process->priority == priority){
+        TracePrintf(1, "EXIT set_effective_priority, priority unchanged.\n");
+        return;
+    }
+
+    TracePrintf(1, "Process %d priority %d -> %d.\n", process->pid, process->priority, priority);
+    process->priority = priority;
+    // A ready process has to move to keep the ready queue ordered
+    if(process->state == PROCESS_READY){
+        sched_dequeue(process);
+        sched_enqueue(process);
+    }
+    TracePrintf(1, "EXIT set_effective_priority.\n");
+}
+
 void remove_from_ready_queue(pcb_t *process) {
     TracePrintf(1, "ENTER remove_from_ready_queue.\n");
     if(process == NULL){
@@ -120,7 +221,7 @@ void remove_from_ready_queue(pcb_t *process) {
         return;
     }
     process->state = PROCESS_DEFAULT;
-    list_remove(ready_queue, &process->queue_node);
+    sched_dequeue(process);
     TracePrintf(1, "EXIT remove_from_ready_queue.\n");
 }
 
@@ -157,6 +258,41 @@ void remove_from_delay_queue(pcb_t *process) {
     TracePrintf(1, "EXIT remove_from_delay_queue.\n");
 }
 
+void add_to_timeout_queue(pcb_t *process, int ticks, list_t *wait_list) {
+    TracePrintf(1, "ENTER add_to_timeout_queue.\n");
+    if(process == NULL){
+        TracePrintf(1, "ERROR, process was not an initialized pcb.\n");
+        return;
+    }
+    if (process->state != PROCESS_BLOCKED) {
+        TracePrintf(1, "ERROR, The state of the process was not PROCESS_BLOCKED.\n");
+        return;
+    }
+
+    process->timeout_ticks = ticks;
+    process->wait_list = wait_list;
+    process->timed_out = false;
+    insert_tail(timeout_queue, &process->timeout_node);
+    TracePrintf(1, "EXIT add_to_timeout_queue.\n");
+}
+
+void remove_from_timeout_queue(pcb_t *process) {
+    TracePrintf(1, "ENTER remove_from_timeout_queue.\n");
+    if(process == NULL){
+        TracePrintf(1, "ERROR, process was not an initialized pcb.\n");
+        return;
+    }
+    if (process->wait_list == NULL) {
+        TracePrintf(1, "ERROR, The process has no timed wait pending.\n");
+        return;
+    }
+
+    list_remove(timeout_queue, &process->timeout_node);
+    process->wait_list = NULL;
+    process->timeout_ticks = 0;
+    TracePrintf(1, "EXIT remove_from_timeout_queue.\n");
+}
+
 void add_to_zombie_queue(pcb_t *process) {
     TracePrintf(1, "ENTER add_to_zombie_queue.\n");
     if(process == NULL){
@@ -224,14 +360,14 @@ pcb_t *find_zombie_child(pcb_t *process) {
         TracePrintf(1, "ERROR, process was not an initialized.\n");
         return NULL;
     }
-    if(list_is_empty(&process->children)) {
+    if(list_is_empty(&process->cold->children)) {
         TracePrintf(1, "ERROR the process has no children.\n");
         return NULL;
     }
 
-    int len = process->children.count;
+    int len = process->cold->children.count;
     TracePrintf(1, "The process has %d children.\n", len);
-    list_node_t *curr = peek(&process->children);
+    list_node_t *curr = peek(&process->cold->children);
     // Iterate through process's children list
   
     int c = 0;
@@ -290,9 +426,9 @@ void check_zombies(void) {
     while(curr != head){
         list_node_t *next = curr->next; // Store next before removal
         pcb_t *curr_pcb = pcb_from_queue_node(curr);
-        if(curr_pcb->parent == NULL){
+        if(curr_pcb->cold->parent == NULL){
             remove_from_zombie_queue(curr_pcb);
-            free(curr_pcb);
+            free_pcb(curr_pcb);
         } 
         curr = next;
     }
@@ -324,6 +460,17 @@ pcb_t *list_contains_pid(list_t *list, int pid){
     return NULL;
 }
 
+pcb_t *find_child(pcb_t *parent, int pid) {
+    list_node_t *head = &parent->cold->children.head;
+    list_node_t *curr = head->next;
+    while(curr != head){
+        pcb_t *child = pcb_from_children_node(curr);
+        if(child->pid == pid) return child;
+        curr = curr->next;
+    }
+    return NULL;
+}
+
 void add_child(pcb_t *parent, pcb_t *child) {
     TracePrintf(1, "ENTER add_child.\n");
     if(parent == NULL){
@@ -335,9 +482,9 @@ void add_child(pcb_t *parent, pcb_t *child) {
     }
 
     // Set child's parent pointer to parent
-    child->parent = parent;
+    child->cold->parent = parent;
     // Add child's children_node to parent's children list
-    insert_tail(&parent->children, &child->children_node);
+    insert_tail(&parent->cold->children, &child->cold->children_node);
     TracePrintf(1, "EXIT add_child.\n");
 }
 
@@ -347,14 +494,14 @@ void remove_child(pcb_t *child) {
         TracePrintf(1, "ERROR, The child was not an initialized pcb.\n");
         return;
     }
-    if (child->parent == NULL){
+    if (child->cold->parent == NULL){
         TracePrintf(1, "ERROR, The child has no parent.\n");
         return;
     }
     // Remove child's children_node from parent's children list
-    list_remove(&child->parent->children, &child->children_node);
+    list_remove(&child->cold->parent->cold->children, &child->cold->children_node);
     // Set child's parent pointer to NULL
-    child->parent = NULL;
+    child->cold->parent = NULL;
     TracePrintf(1, "EXIT remove_child.\n");
 }
 
@@ -364,16 +511,16 @@ void orphan_children(pcb_t *parent) {
         TracePrintf(1, "Error: Attempting to orphan children of a NULL PCB.\n");
         return;
     }
-    if(list_is_empty(&current_process->children)) {
+    if(list_is_empty(&current_process->cold->children)) {
         TracePrintf(1, "EXIT orphan_children the process has no children.\n");
         return;
     }
 
     // Iterate through parent's children list and set each child's parent to NULL
-    while (!list_is_empty(&parent->children)) {
-        pcb_t *child = pcb_from_children_node(pop(&parent->children));
-        if (child->state == PROCESS_ZOMBIE) free(child);
-        else child->parent = NULL;
+    while (!list_is_empty(&parent->cold->children)) {
+        pcb_t *child = pcb_from_children_node(pop(&parent->cold->children));
+        if (child->state == PROCESS_ZOMBIE) free_pcb(child);
+        else child->cold->parent = NULL;
     }
     TracePrintf(1, "EXIT orphan_children.\n");
 }
@@ -388,21 +535,28 @@ void free_userspace(pcb_t *proc){
     //   Get physical frame number
     //   Unmap the virtual page
     //   Free the physical frame
+    // File mappings go first so their pages are written back before the frames are freed
+    mmap_release_regions(proc);
     TracePrintf(1, "Starting to free region 1 page table.\n");
     for (int i = 0; i < MAX_PT_LEN; i++) {
         // Get the ith page table entry
-        pte_t entry = proc->region1_pt[i];
-        if (entry.valid) {
-            // free the pfn
-            int pfn = entry.pfn;
+        pte_t *entry = &proc->region1_pt[i];
+        if (entry->valid) {
+            // free the pfn, a shared frame only loses this process's reference
+            int pfn = entry->pfn;
             TracePrintf(1, "Freeing physical frame %d corresponding to virtual page %d\n", pfn, i);
             free_frame(pfn);
-            entry.pfn = 0;
+            entry->pfn = 0;
             // Set the protections and validity of the page to all 0
-            entry.prot = 0;
-            entry.valid = 0;
+            entry->prot = 0;
+            entry->valid = 0;
+            proc->cold->page_meta[i].cow = false;
+        } else {
+            // Pages the pager is holding still own a frame or a swap slot
+            swap_discard(proc, i);
         }
     }
+    shm_release_maps(proc);
     TracePrintf(1, "Exit free_userspace.\n");
 }
 
@@ -420,7 +574,7 @@ void free_process_memory(pcb_t *proc) {
     // For each frame in kernel_stack_pages:
     //   Free the physical frame
     for(int i = 0; i < KERNEL_STACK_MAXSIZE >> PAGESHIFT; i++){
-        pte_t entry = proc->kernel_stack[i];
+        pte_t entry = proc->cold->kernel_stack[i];
         int pfn = entry.pfn;
         free_frame(pfn);
     }
@@ -434,16 +588,23 @@ void terminate_process(pcb_t *process, int status) {
     }
    
     // Set process exit code to state
-    process->exit_code = status;
+    process->cold->exit_code = status;
     process->state = PROCESS_DEFAULT;
 
+    // Give back its real-time reservation
+    if (process->rt) rt_release(process);
+
+    // Locks it still holds go to their next waiter, otherwise they would point at a freed PCB
+    SyncReleaseHeld(process);
+
     // Orphan children if any (set their parent to NULL)
     orphan_children(process);
     
     // Release process resources except PCB itself
     free_process_memory(process);
-    free(process->kernel_stack);
+    free(process->cold->kernel_stack);
     free(process->region1_pt);
+    free(process->cold->page_meta);
     
     // Remove from any queue the process might be in
     if (process->state != PROCESS_ZOMBIE) {
@@ -457,17 +618,15 @@ void terminate_process(pcb_t *process, int status) {
     }
 
     // Check if the parent is waiting on it's children
-    if(process->parent != NULL && process->parent->waiting_for_children){
-        TracePrintf(1, "The process's parent %d is already waiting, unblocking it.\n", process->parent->pid);
-        remove_from_blocked_queue(process->parent);
-        add_to_ready_queue(process->parent);
-        if ((int *)process->parent->user_context.regs[0] != NULL){
-            int *status_ptr = (int *) process->parent->user_context.regs[0];
-            *status_ptr = status;
-        }
-        process->parent->user_context.regs[0] = process->pid;
-
-        free(process);
+    if(process->cold->parent != NULL && process->cold->parent->cold->waiting_for_children){
+        TracePrintf(1, "The process's parent %d is already waiting, unblocking it.\n", process->cold->parent->pid);
+        remove_from_blocked_queue(process->cold->parent);
+        add_to_ready_queue(process->cold->parent);
+        // Wait picks these up when the parent switches back in
+        process->cold->parent->cold->child_status = status;
+        process->cold->parent->cold->user_context.regs[0] = process->pid;
+
+        free_pcb(process);
         return;
     }
     
@@ -20,6 +20,11 @@
 
 #define DEFAULT_TIMESLICE 4
 
+// Scheduling priorities, a higher value runs first
+#define MIN_PRIORITY 0
+#define DEFAULT_PRIORITY 8
+#define MAX_PRIORITY 15
+
  
 typedef enum {
     PROCESS_DEFAULT,
@@ -30,61 +35,112 @@ typedef enum {
     PROCESS_ZOMBIE    // Terminated but not reaped
 } state_t;
 
-typedef struct pcb {
+/**
+ * The parts of a process the scheduler and clock handler never read: the
+ * contexts, blocked call state, sync and memory bookkeeping, statistics
+ * and the family links. They live in their own allocation so the queue
+ * walks in the scheduler and clock handler only pull in pcb_t.
+ */
+typedef struct pcb_cold {
     // Process context
     UserContext user_context;      // User context (saved registers, PC, etc.)
     KernelContext kernel_context;  // Kernel context
 
-    // Process identification
-    int pid;   // Process ID
+    // Terminal I/O
+    char *tty_read_buffer;  // Buffer for terminal read
+    int tty_read_len;       // Length of requested read
+    int tty_read_terminal;  // Terminal ID for read
 
-    // Memory management
-    pte_t *region1_pt;                            // Region 1 page table
-    pte_t *kernel_stack;                                  // Pointer to physical frames for kernel stack
-    void *brk;                                                // Current program break (heap limit)
+    char *tty_write_buffer;  // Buffer for terminal write
+    int tty_write_len;       // Length of requested write
+    int tty_write_terminal;  // Terminal ID for write
+    int tty_write_offset;    // Current offset in write buffer
 
-    // Process state
-    state_t state;
+    // Blocked pipe call
+    int waiting_pipe_id;  // ID of pipe being waited for
+    void *pipe_buffer;
+    int pipe_len;
+    int write_loc;
 
-    // Scheduling
-    int time_slice;  // Time quantum for this process
-    int run_time;    // How long process has been running
+    // Synchronization
+    int waiting_lock_id;  // ID of lock being waited for
+    int waiting_cvar_id;  // ID of condition variable being waited for
+    int cvar_lock_id;     // Lock a cvar waiter is moved onto when it is signalled
+    list_t held_locks;    // Locks currently owned, used to recompute inherited priority
+    list_t rw_holds;      // rw_hold_t's of the rwlocks it holds for reading or writing
+    bool rw_write;        // True if queued on an rwlock for writing, false for reading
+    int sem_wanted;       // Count requested while queued on a semaphore
+    unsigned int futex_key;  // Physical address being waited on in a futex queue
+    int futex_vpn;           // Region 1 page behind futex_key, pinned against paging while queued
 
-    // Delay information
-    int delay_ticks;  // Ticks remaining for Delay syscall
+    // Memory management
+    list_t shm_maps;              // Shared segment ranges mapped in Region 1
+    list_t mmap_regions;          // Host file mappings, filled in on fault
+    struct page_meta *page_meta;  // Pager state for each Region 1 page
+    pte_t *kernel_stack;          // Pointer to physical frames for kernel stack
+    void *heap_base;              // Region 1 relative start of the heap, brk never goes below it
+    void *brk;                    // Current program break (heap limit)
+
+    // Memory statistics
+    int minor_faults;  // Faults resolved without I/O, e.g. a revoked page touched again
+    int major_faults;  // Faults that read a page from the swap file or a mapped file
+    int cow_breaks;    // Copy on write pages given a private copy
+    int working_set;   // Pages touched during the last sampling interval
 
     // Exit information
     int exit_code;      // Exit code when process terminates
 
     // Process relationships
+    struct pcb *proc;          // The pcb_t this belongs to, for pcb_from_children_node
     struct pcb *parent;        // Pointer to parent PCB
     list_t children;           // List of children PCBs
+    list_node_t children_node; // Node for parent's children list
     int waiting_for_children;  // True if process is blocked on Wait
+    int child_status;          // Exit status handed over by the child that ended a blocked Wait
 
-    // Terminal I/O
-    char *tty_read_buffer;  // Buffer for terminal read
-    int tty_read_len;       // Length of requested read
-    int tty_read_terminal;  // Terminal ID for read
+    bool should_fork;
+} pcb_cold_t;
 
-    char *tty_write_buffer;  // Buffer for terminal write
-    int tty_write_len;       // Length of requested write
-    int tty_write_terminal;  // Terminal ID for write
-    int tty_write_offset;    // Current offset in write buffer
+typedef struct pcb {
+    // Scheduling, read on every queue walk so it sits together at the front
+    list_node_t queue_node;  // Node for all queues
+    state_t state;
+    int priority;       // Effective priority (base or inherited through a lock)
+    int base_priority;  // Priority the process asked for
+    int time_slice;     // Time quantum for this process
+    int run_time;       // How long process has been running
+    int delay_ticks;    // Ticks remaining for Delay syscall
+    struct pcb *handoff;  // Peer this process last woke, schedule runs it next if it can
+    int tickets;              // CPU share under the stride policy
+    int lent_tickets;         // Tickets lent by processes blocked on locks it holds, see SyncRestorePriority
+    unsigned int stride;      // STRIDE1 / tickets
+    unsigned int pass;        // Virtual time, advanced by stride for every tick run
+    int pass_remain;          // Pass relative to the global pass when the process last blocked
+
+    // Real-time class
+    bool rt;                  // Scheduled earliest deadline first, ahead of the normal class
+    bool rt_throttled;        // Used up its budget, off every queue until its next period
+    int rt_period;            // Ticks per period
+    int rt_budget;            // Ticks it may run in each period
+    int rt_used;              // Ticks run so far in this period
+    unsigned int rt_deadline; // clock_ticks value at which the current period ends
+    list_node_t rt_node;      // Node in the list of admitted real-time processes
+
+    // Timed waits
+    list_node_t timeout_node;  // Node in the timeout queue while a timed wait is pending
+    int timeout_ticks;         // Ticks left before the timed wait gives up
+    list_t *wait_list;         // Object wait list the timed wait is queued on, NULL if none
+    bool timed_out;            // Set when the last timed wait gave up
+    bool polling;              // True while blocked in Poll waiting for any watched object
 
-    // Synchronization
-    int waiting_lock_id;  // ID of lock being waited for
-    int waiting_cvar_id;  // ID of condition variable being waited for
-    int waiting_pipe_id;  // ID of pipe being waited for
+    // Process identification
+    int pid;   // Process ID
 
-    // Queue nodes (intrusive linked list nodes)
-    list_node_t queue_node;     // Node for all queues
-    list_node_t children_node;  // Node for parent's children list
-    
-    void *pipe_buffer;
-    int pipe_len;
-    int write_loc;
-    
-    bool should_fork;
+    // Contexts, sync and memory bookkeeping, and process relationships, see pcb_cold_t
+    pcb_cold_t *cold;
+
+    // Region 1 page table, switched in by schedule and walked by the pager
+    pte_t *region1_pt;
 } pcb_t;
 
 
@@ -93,7 +149,9 @@ typedef struct pcb {
 
 // Macros to get PCB from its various nodes
 #define pcb_from_queue_node(ptr) container_of(ptr, pcb_t, queue_node)
-#define pcb_from_children_node(ptr) container_of(ptr, pcb_t, children_node)
+#define pcb_from_children_node(ptr) (container_of(ptr, pcb_cold_t, children_node)->proc)
+#define pcb_from_timeout_node(ptr) container_of(ptr, pcb_t, timeout_node)
+#define pcb_from_rt_node(ptr) container_of(ptr, pcb_t, rt_node)
 
 // Process queues and current process
 extern list_t *ready_queue;      // Processes ready to run
@@ -101,6 +159,7 @@ extern list_t *delay_queue;      // Processes waiting for Delay
 // THIS MIGHT BE ABSTRACTED FURTHER LATER (probably not though)
 extern list_t *blocked_queue;    // Processes blocking for some other reasons
 extern list_t *zombie_queue;     // Terminated but not reaped processes
+extern list_t *timeout_queue;    // Processes in a timed wait, linked through timeout_node
 extern pcb_t *current_process;  // Currently executing process
 extern pcb_t *idle_process;
 
@@ -122,6 +181,15 @@ int init_pcb_system(void);
 pcb_t *create_pcb(void);
 
 
+/**
+ * Free a PCB and its cold part
+ * The process's other resources must already be released
+ *
+ * @param process PCB to free
+ */
+void free_pcb(pcb_t *process);
+
+
 /**
  * Add process to ready queue
  *
@@ -130,6 +198,26 @@ pcb_t *create_pcb(void);
 void add_to_ready_queue(pcb_t *process);
 
 
+/**
+ * Insert a process into a queue ordered by effective priority
+ * Processes of equal priority stay in FIFO order
+ *
+ * @param list Queue to insert into
+ * @param process PCB to insert
+ */
+void insert_by_priority(list_t *list, pcb_t *process);
+
+
+/**
+ * Change the effective priority of a process
+ * Repositions the process if it is sitting in the ready queue
+ *
+ * @param process PCB to update
+ * @param priority New effective priority
+ */
+void set_effective_priority(pcb_t *process, int priority);
+
+
 /**
  * Remove process from ready queue
  *
@@ -155,6 +243,25 @@ void add_to_delay_queue(pcb_t *process, int ticks);
 void remove_from_delay_queue(pcb_t *process);
 
 
+/**
+ * Start the clock on a timed wait
+ * The process stays on its object's wait list as well, whichever fires first wins
+ *
+ * @param process PCB that is blocked on wait_list
+ * @param ticks Number of clock ticks before the wait gives up
+ * @param wait_list The object wait list the process is queued on
+ */
+void add_to_timeout_queue(pcb_t *process, int ticks, list_t *wait_list);
+
+
+/**
+ * Stop the clock on a timed wait
+ *
+ * @param process PCB to remove
+ */
+void remove_from_timeout_queue(pcb_t *process);
+
+
 /**
  * Add process to zombie queue
  *
@@ -241,6 +348,13 @@ void orphan_children(pcb_t *parent);
 
 
 void free_userspace(pcb_t *proc);
+
+/**
+ * Find a direct child of parent by pid
+ *
+ * @return The child's PCB, or NULL if parent has no such child
+ */
+pcb_t *find_child(pcb_t *parent, int pid);
 /**
  * Frees all memory in relation to a process
  * 
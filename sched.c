@@ -0,0 +1,323 @@
+/**
+ * Date: 5/27/25
+ * File: sched.c
+ * Description: Priority and stride scheduling policies for Yalnix OS
+ */
+
+#include <yalnix.h>
+#include <ykernel.h>
+#include <string.h>
+
+#include "sched.h"
+#include "traps.h"
+
+/* ------------------------------------------------------------------ Priority policy ----------------------------------------------------- */
+
+// Highest effective priority first, round robin within a priority
+
+static void prio_enqueue(pcb_t *proc){
+    insert_by_priority(ready_queue, proc);
+}
+
+static void prio_dequeue(pcb_t *proc){
+    list_remove(ready_queue, &proc->queue_node);
+}
+
+static pcb_t *prio_pick_next(void){
+    list_node_t *node = pop(ready_queue);
+    return node == NULL ? NULL : pcb_from_queue_node(node);
+}
+
+static bool prio_tick(pcb_t *curr){
+    curr->run_time++;
+    if(curr->run_time <= curr->time_slice){
+        TracePrintf(1, "The process has taken %d of %d timeslices.\n", curr->run_time, curr->time_slice);
+        return false;
+    }
+    TracePrintf(1, "The process has reached it's max timeslices %d.\n", curr->time_slice);
+    // The ready queue is ordered by priority, so only the head can take over from curr
+    if(ready_queue->count != 0 && pcb_from_queue_node(peek(ready_queue))->priority >= curr->priority){
+        return true;
+    }
+    TracePrintf(1, "But there were no other processes of equal or higher priority to run.\n");
+    curr->run_time = 0;
+    return false;
+}
+
+// Priorities carry no history, so there is nothing to track while a process is away
+static void prio_on_block(pcb_t *proc){
+}
+
+static void prio_on_wake(pcb_t *proc){
+}
+
+static bool prio_can_handoff(pcb_t *peer){
+    // Never jump the peer ahead of a process with a higher priority
+    return peer->priority >= pcb_from_queue_node(peek(ready_queue))->priority;
+}
+
+static const sched_ops_t prio_ops = {
+    "priority", prio_enqueue, prio_dequeue, prio_pick_next, prio_tick, prio_on_block, prio_on_wake, prio_can_handoff
+};
+
+/* ------------------------------------------------------------------ Stride policy ------------------------------------------------------- */
+
+// Lowest pass first, so each process runs in proportion to its tickets. Effective priority is ignored,
+// a lock owner inherits through the tickets its waiters lend it instead (sched_lend_tickets).
+
+// Pass of the process picked last, a process that was away rejoins relative to it rather than banking credit
+static unsigned int stride_global_pass = 0;
+
+// Passes (and tick counts) wrap, so compare them by their difference
+static int pass_cmp(unsigned int a, unsigned int b){
+    return (int)(a - b);
+}
+
+// The stride follows the tickets a process owns plus those lent to it
+static void stride_update(pcb_t *proc){
+    unsigned int stride = STRIDE1 / (proc->tickets + proc->lent_tickets);
+    proc->stride = stride == 0 ? 1 : stride;
+}
+
+static void stride_enqueue(pcb_t *proc){
+    // Walk back from the tail so equal passes stay FIFO
+    list_node_t *head = &ready_queue->head;
+    list_node_t *curr = head->prev;
+    while(curr != head && pass_cmp(pcb_from_queue_node(curr)->pass, proc->pass) > 0){
+        curr = curr->prev;
+    }
+
+    // Link the process in right after curr
+    list_node_t *node = &proc->queue_node;
+    node->prev = curr;
+    node->next = curr->next;
+    curr->next->prev = node;
+    curr->next = node;
+    ready_queue->count++;
+}
+
+static void stride_dequeue(pcb_t *proc){
+    list_remove(ready_queue, &proc->queue_node);
+}
+
+static pcb_t *stride_pick_next(void){
+    list_node_t *node = pop(ready_queue);
+    if(node == NULL) return NULL;
+    pcb_t *next = pcb_from_queue_node(node);
+    stride_global_pass = next->pass;
+    return next;
+}
+
+static bool stride_tick(pcb_t *curr){
+    curr->run_time++;
+    if(curr != idle_process) curr->pass += curr->stride;
+    if(curr->run_time <= curr->time_slice) return false;
+
+    // Idle gives way to anything, everyone else only to a process that is further behind
+    if(ready_queue->count != 0 &&
+       (curr == idle_process || pass_cmp(pcb_from_queue_node(peek(ready_queue))->pass, curr->pass) <= 0)){
+        return true;
+    }
+    curr->run_time = 0;
+    return false;
+}
+
+static void stride_on_block(pcb_t *proc){
+    // Remember how far ahead of (or behind) everyone else the process was when it left
+    proc->pass_remain = pass_cmp(proc->pass, stride_global_pass);
+}
+
+static void stride_on_wake(pcb_t *proc){
+    proc->pass = stride_global_pass + proc->pass_remain;
+    proc->pass_remain = 0;
+}
+
+static bool stride_can_handoff(pcb_t *peer){
+    // The peer is charged for the time it runs, so let it go first if it is within a quantum of the head
+    return pass_cmp(peer->pass, pcb_from_queue_node(peek(ready_queue))->pass) <= (int)peer->stride;
+}
+
+static const sched_ops_t stride_ops = {
+    "stride", stride_enqueue, stride_dequeue, stride_pick_next, stride_tick, stride_on_block, stride_on_wake, stride_can_handoff
+};
+
+/* ------------------------------------------------------------------ Real-time class ----------------------------------------------------- */
+
+// Earliest deadline first, ahead of whatever the policy would pick. Each process is held to budget ticks per period.
+
+// Runnable real-time processes linked through queue_node, earliest deadline first
+static list_t rt_queue;
+// Every admitted process linked through rt_node, so the clock can start their periods
+static list_t rt_procs;
+// Sum of budget / period over rt_procs, in thousandths
+static int rt_util = 0;
+
+static int rt_share(int period, int budget){
+    return (budget * 1000 + period - 1) / period;
+}
+
+static void rt_enqueue(pcb_t *proc){
+    // Walk back from the tail so equal deadlines stay FIFO
+    list_node_t *head = &rt_queue.head;
+    list_node_t *curr = head->prev;
+    while(curr != head && pass_cmp(pcb_from_queue_node(curr)->rt_deadline, proc->rt_deadline) > 0){
+        curr = curr->prev;
+    }
+
+    list_node_t *node = &proc->queue_node;
+    node->prev = curr;
+    node->next = curr->next;
+    curr->next->prev = node;
+    curr->next = node;
+    rt_queue.count++;
+}
+
+// Start a new period for every real-time process whose deadline has passed
+static void rt_replenish(void){
+    list_node_t *head = &rt_procs.head;
+    for(list_node_t *curr = head->next; curr != head; curr = curr->next){
+        pcb_t *proc = pcb_from_rt_node(curr);
+        if(pass_cmp(clock_ticks, proc->rt_deadline) < 0) continue;
+        // Skip any periods it missed entirely, e.g. while blocked
+        while(pass_cmp(clock_ticks, proc->rt_deadline) >= 0) proc->rt_deadline += proc->rt_period;
+        proc->rt_used = 0;
+        if(proc->rt_throttled){
+            proc->rt_throttled = false;
+            TracePrintf(1, "Real-time process %d starts a new period, no longer throttled.\n", proc->pid);
+            add_to_ready_queue(proc);
+        }
+    }
+}
+
+// Charge a running real-time process, true if it has to give up the CPU
+static bool rt_charge(pcb_t *curr){
+    curr->rt_used++;
+    if(curr->rt_used >= curr->rt_budget){
+        TracePrintf(1, "Real-time process %d used its budget of %d, throttled until tick %u.\n",
+                    curr->pid, curr->rt_budget, curr->rt_deadline);
+        curr->rt_throttled = true;
+        return true;
+    }
+    // A process whose new period started may now have the earlier deadline
+    return rt_queue.count != 0 &&
+           pass_cmp(pcb_from_queue_node(peek(&rt_queue))->rt_deadline, curr->rt_deadline) < 0;
+}
+
+int rt_set(pcb_t *proc, int period, int budget){
+    int old = proc->rt ? rt_share(proc->rt_period, proc->rt_budget) : 0;
+    if(period == 0){
+        if(proc->rt) rt_release(proc);
+        return SUCCESS;
+    }
+    if(period < 0 || budget <= 0 || budget > period){
+        TracePrintf(1, "ERROR, budget %d in period %d is not a valid reservation.\n", budget, period);
+        return ERROR;
+    }
+
+    // Admission control, the reservations have to fit under the bound together
+    int share = rt_share(period, budget);
+    if(rt_util - old + share > RT_UTIL_BOUND){
+        TracePrintf(1, "ERROR, admitting %d/%d would reserve %d/1000 of the CPU, the bound is %d.\n",
+                    budget, period, rt_util - old + share, RT_UTIL_BOUND);
+        return ERROR;
+    }
+    rt_util += share - old;
+
+    if(!proc->rt) insert_tail(&rt_procs, &proc->rt_node);
+    proc->rt = true;
+    proc->rt_throttled = false;
+    proc->rt_period = period;
+    proc->rt_budget = budget;
+    proc->rt_used = 0;
+    proc->rt_deadline = clock_ticks + period;
+    TracePrintf(1, "Process %d admitted as real-time, %d ticks every %d, %d/1000 reserved.\n",
+                proc->pid, budget, period, rt_util);
+    return SUCCESS;
+}
+
+void rt_release(pcb_t *proc){
+    rt_util -= rt_share(proc->rt_period, proc->rt_budget);
+    list_remove(&rt_procs, &proc->rt_node);
+    proc->rt = false;
+    proc->rt_throttled = false;
+}
+
+/* ------------------------------------------------------------------ Class dispatch ------------------------------------------------------ */
+
+void sched_enqueue(pcb_t *proc){
+    if(proc->rt) rt_enqueue(proc);
+    else sched->enqueue(proc);
+}
+
+void sched_dequeue(pcb_t *proc){
+    if(proc->rt) list_remove(&rt_queue, &proc->queue_node);
+    else sched->dequeue(proc);
+}
+
+pcb_t *sched_pick_next(void){
+    list_node_t *node = pop(&rt_queue);
+    if(node != NULL) return pcb_from_queue_node(node);
+    return sched->pick_next();
+}
+
+bool sched_tick(pcb_t *curr){
+    rt_replenish();
+    if(curr->rt) return rt_charge(curr);
+    // Any runnable real-time process goes ahead of the normal class
+    if(rt_queue.count != 0){
+        curr->run_time = 0;
+        return true;
+    }
+    return sched->tick(curr);
+}
+
+bool sched_can_handoff(pcb_t *peer){
+    if(peer->rt) return pass_cmp(peer->rt_deadline, pcb_from_queue_node(peek(&rt_queue))->rt_deadline) <= 0;
+    return rt_queue.count == 0 && sched->can_handoff(peer);
+}
+
+/* ------------------------------------------------------------------ Policy selection ---------------------------------------------------- */
+
+const sched_ops_t *sched = &prio_ops;
+
+static const sched_ops_t *sched_policies[] = { &prio_ops, &stride_ops };
+
+int sched_init(char *cmd_args[]){
+    TracePrintf(1, "Enter sched_init.\n");
+    list_init(&rt_queue);
+    list_init(&rt_procs);
+    int first = 0;
+    int prefix_len = strlen(SCHED_ARG_PREFIX);
+    while(cmd_args != NULL && cmd_args[first] != NULL && strncmp(cmd_args[first], SCHED_ARG_PREFIX, prefix_len) == 0){
+        char *name = cmd_args[first] + prefix_len;
+        int found = 0;
+        for(size_t i = 0; i < sizeof(sched_policies) / sizeof(sched_policies[0]); i++){
+            if(strcmp(name, sched_policies[i]->name) == 0){
+                sched = sched_policies[i];
+                found = 1;
+            }
+        }
+        if(!found) TracePrintf(0, "Unknown scheduling policy %s, keeping %s.\n", name, sched->name);
+        first++;
+    }
+    TracePrintf(0, "Scheduling policy: %s.\n", sched->name);
+    TracePrintf(1, "Exit sched_init.\n");
+    return first;
+}
+
+int sched_set_tickets(pcb_t *proc, int tickets){
+    if(tickets < 1 || tickets > SCHED_MAX_TICKETS){
+        TracePrintf(1, "ERROR, %d tickets is outside of [1, %d].\n", tickets, SCHED_MAX_TICKETS);
+        return ERROR;
+    }
+    proc->tickets = tickets;
+    stride_update(proc);
+    return SUCCESS;
+}
+
+void sched_lend_tickets(pcb_t *proc, int lent){
+    if(proc->lent_tickets == lent) return;
+    TracePrintf(1, "Process %d is lent %d tickets on top of its %d.\n", proc->pid, lent, proc->tickets);
+    proc->lent_tickets = lent;
+    stride_update(proc);
+}
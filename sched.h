@@ -0,0 +1,149 @@
+/**
+ * Date: 5/27/25
+ * File: sched.h
+ * Description: Pluggable scheduling policies for Yalnix OS
+ */
+
+#ifndef _SCHED_H_
+#define _SCHED_H_
+
+#include <stdbool.h>
+#include <hardware.h>
+#include "pcb.h"
+
+// Boot option that picks the policy, e.g. "-sched=stride" ahead of the init program's name
+#define SCHED_ARG_PREFIX "-sched="
+
+// Real-time processes may reserve at most this much of the CPU between them, in thousandths
+#define RT_UTIL_BOUND 900
+
+// Stride scheduling: a process's stride is STRIDE1 / tickets, its pass advances by its stride every tick it runs
+#define STRIDE1 10000
+#define SCHED_DEFAULT_TICKETS 100
+#define SCHED_MAX_TICKETS 1000
+
+/**
+ * A scheduling policy. The runnable processes stay in ready_queue, each
+ * policy keeps it in its own order.
+ */
+typedef struct sched_ops {
+    const char *name;
+
+    // Add a process whose state is already PROCESS_READY
+    void (*enqueue)(pcb_t *proc);
+
+    // Take a ready process back out, e.g. to reposition it
+    void (*dequeue)(pcb_t *proc);
+
+    // Remove and return the process to run next, NULL if none is ready
+    pcb_t *(*pick_next)(void);
+
+    // Charge the running process for a clock tick, true if it should be preempted now
+    bool (*tick)(pcb_t *curr);
+
+    // The process stopped running without staying runnable (blocked, delayed or exited)
+    void (*on_block)(pcb_t *proc);
+
+    // A process that was not running becomes ready (woken, or new)
+    void (*on_wake)(pcb_t *proc);
+
+    // Whether a woken peer may run ahead of the rest of ready_queue on a directed handoff
+    bool (*can_handoff)(pcb_t *peer);
+} sched_ops_t;
+
+// The policy in use, chosen once at boot
+extern const sched_ops_t *sched;
+
+/**
+ * Pick the policy from the boot arguments
+ *
+ * Leading SCHED_ARG_PREFIX options are consumed, the default is the
+ * priority policy.
+ *
+ * @param cmd_args The KernelStart arguments
+ * @return The index of the first argument that is not a kernel option
+ */
+int sched_init(char *cmd_args[]);
+
+/**
+ * Add a ready process to its class's run queue
+ * Real-time processes go to the EDF queue, everyone else to the policy
+ *
+ * @param proc Process whose state is already PROCESS_READY
+ */
+void sched_enqueue(pcb_t *proc);
+
+/**
+ * Take a ready process back out of its class's run queue
+ *
+ * @param proc Process to remove
+ */
+void sched_dequeue(pcb_t *proc);
+
+/**
+ * Remove and return the process to run next
+ * The earliest deadline real-time process wins, then the policy decides
+ *
+ * @return The next process, or NULL if nothing is ready
+ */
+pcb_t *sched_pick_next(void);
+
+/**
+ * Charge the running process for a clock tick
+ * Also starts new periods for real-time processes, un-throttling them
+ *
+ * @param curr The running process
+ * @return true if curr should be preempted now
+ */
+bool sched_tick(pcb_t *curr);
+
+/**
+ * Whether a woken peer may run ahead of every other ready process
+ *
+ * @param peer A ready process
+ */
+bool sched_can_handoff(pcb_t *peer);
+
+/**
+ * Move the current process into (or out of) the real-time class
+ *
+ * The process is admitted only if the total budget / period of all
+ * real-time processes stays within RT_UTIL_BOUND. Its first deadline is
+ * one period from now.
+ *
+ * @param proc The current process
+ * @param period Ticks per period, 0 to go back to the normal class
+ * @param budget Ticks it may run in each period, at most period
+ * @return SUCCESS, or ERROR if the arguments are bad or it would not fit
+ */
+int rt_set(pcb_t *proc, int period, int budget);
+
+/**
+ * Take an exiting process out of the real-time class
+ *
+ * @param proc The process
+ */
+void rt_release(pcb_t *proc);
+
+/**
+ * Give a process a new share of the CPU under the stride policy
+ *
+ * @param proc Process to update
+ * @param tickets Between 1 and SCHED_MAX_TICKETS
+ * @return SUCCESS, or ERROR if tickets is out of range
+ */
+int sched_set_tickets(pcb_t *proc, int tickets);
+
+/**
+ * Set the tickets lent to a process by the processes blocked on its locks
+ *
+ * This is priority inheritance under the stride policy: a lock owner runs
+ * on its own tickets plus those of everyone waiting on it, so it gets out
+ * of their way as fast as their combined share allows.
+ *
+ * @param proc Lock owner
+ * @param lent Total tickets of its waiters, 0 once none are left
+ */
+void sched_lend_tickets(pcb_t *proc, int lent);
+
+#endif /* _SCHED_H_ */
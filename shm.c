@@ -0,0 +1,142 @@
+/**
+ * Date: 5/21/25
+ * File: shm.c
+ * Description: Shared memory implementation for Yalnix OS
+ */
+
+#include <yalnix.h>
+#include <ykernel.h>
+
+#include "shm.h"
+#include "sync.h"
+#include "frames.h"
+#include "context_switch.h"
+#include "memory.h"
+
+int shm_create(int *shm_idp, int size){
+    TracePrintf(1, "Enter shm_create with size %d.\n", size);
+    int npages = UP_TO_PAGE(size) >> PAGESHIFT;
+    if(size <= 0 || npages > SHM_MAX_PAGES){
+        TracePrintf(1, "ERROR, shared segment size %d is outside of (0, %d].\n", size, SHM_MAX_PAGES * PAGESIZE);
+        return ERROR;
+    }
+    if(global_sync_counter >= MAX_SYNCS){
+        TracePrintf(1, "ERROR, the maximum number of synchronization constants has been reached.\n");
+        return ERROR;
+    }
+
+    shm_segment_t *seg = (shm_segment_t *)malloc(sizeof(shm_segment_t));
+    if(seg == NULL){
+        TracePrintf(1, "ERROR, the new shared segment could not be allocated.\n");
+        return ERROR;
+    }
+    seg->frames = (int *)malloc(npages * sizeof(int));
+    if(seg->frames == NULL){
+        TracePrintf(1, "ERROR, the shared segment frame list could not be allocated.\n");
+        free(seg);
+        return ERROR;
+    }
+    seg->npages = 0;
+
+    // Grab every frame up front so attaching never has to allocate
+    for(int i = 0; i < npages; i++){
+        int pfn = allocate_zeroed_frame();
+        if(pfn == ERROR){
+            TracePrintf(1, "ERROR, no frames left for the shared segment.\n");
+            shm_destroy(seg);
+            return ERROR;
+        }
+        seg->frames[seg->npages++] = pfn;
+    }
+
+    int rc = InitSyncObject(SHM, (void *)seg);
+    if(rc == ERROR){
+        TracePrintf(1, "ERROR, there was an issue with allocating the synchonization object.\n");
+        shm_destroy(seg);
+        return ERROR;
+    }
+    *shm_idp = rc;
+    TracePrintf(1, "Exit shm_create, segment %d has %d pages.\n", rc, npages);
+    return SUCCESS;
+}
+
+int shm_attach(int shm_id, void **addrp){
+    TracePrintf(1, "Enter shm_attach.\n");
+    sync_obj_t *sync;
+    if(GetCheckSync(shm_id, SHM, &sync) == ERROR){
+        return ERROR;
+    }
+    shm_segment_t *seg = sync->object.shm;
+    pcb_t *curr = current_process;
+
+    int vpn = find_free_range(curr, seg->npages);
+    if(vpn == ERROR){
+        TracePrintf(1, "ERROR, no room for %d shared pages in process %d.\n", seg->npages, curr->pid);
+        return ERROR;
+    }
+
+    shm_map_t *map = (shm_map_t *)malloc(sizeof(shm_map_t));
+    if(map == NULL){
+        TracePrintf(1, "ERROR, the shared mapping could not be allocated.\n");
+        return ERROR;
+    }
+    map->vpn = vpn;
+    map->npages = seg->npages;
+    insert_tail(&curr->cold->shm_maps, &map->node);
+
+    for(int i = 0; i < seg->npages; i++){
+        frame_ref(seg->frames[i]);
+        curr->region1_pt[vpn + i].pfn = seg->frames[i];
+        curr->region1_pt[vpn + i].prot = PROT_READ | PROT_WRITE;
+        curr->region1_pt[vpn + i].valid = 1;
+        WriteRegister(REG_TLB_FLUSH, VMEM_1_BASE + ((vpn + i) << PAGESHIFT));
+    }
+
+    *addrp = (void *)(VMEM_1_BASE + (vpn << PAGESHIFT));
+    TracePrintf(1, "Exit shm_attach, segment %d mapped at %p in process %d.\n", shm_id, *addrp, curr->pid);
+    return SUCCESS;
+}
+
+void shm_destroy(shm_segment_t *seg){
+    TracePrintf(1, "Enter shm_destroy.\n");
+    // Frames still mapped somewhere stay alive through the mapping's reference
+    for(int i = 0; i < seg->npages; i++){
+        free_frame(seg->frames[i]);
+    }
+    free(seg->frames);
+    free(seg);
+    TracePrintf(1, "Exit shm_destroy.\n");
+}
+
+bool shm_is_shared_page(pcb_t *proc, int vpn){
+    list_node_t *node = proc->cold->shm_maps.head.next;
+    while(node != &proc->cold->shm_maps.head){
+        shm_map_t *map = shm_map_from_node(node);
+        if(vpn >= map->vpn && vpn < map->vpn + map->npages) return true;
+        node = node->next;
+    }
+    return false;
+}
+
+int shm_copy_maps(pcb_t *parent, pcb_t *child){
+    list_node_t *node = parent->cold->shm_maps.head.next;
+    while(node != &parent->cold->shm_maps.head){
+        shm_map_t *map = shm_map_from_node(node);
+        shm_map_t *copy = (shm_map_t *)malloc(sizeof(shm_map_t));
+        if(copy == NULL){
+            TracePrintf(1, "ERROR, could not copy the shared mappings of process %d.\n", parent->pid);
+            return ERROR;
+        }
+        copy->vpn = map->vpn;
+        copy->npages = map->npages;
+        insert_tail(&child->cold->shm_maps, &copy->node);
+        node = node->next;
+    }
+    return SUCCESS;
+}
+
+void shm_release_maps(pcb_t *proc){
+    while(!list_is_empty(&proc->cold->shm_maps)){
+        free(shm_map_from_node(pop(&proc->cold->shm_maps)));
+    }
+}
@@ -0,0 +1,82 @@
+/**
+ * Date: 5/21/25
+ * File: shm.h
+ * Description: Shared memory segments for Yalnix OS
+ */
+
+#ifndef _SHM_H_
+#define _SHM_H_
+
+#include <hardware.h>
+#include "pcb.h"
+
+// Largest segment that can be created, in pages
+#define SHM_MAX_PAGES 64
+
+// A shared segment, it holds one reference on each of its frames until reclaimed
+typedef struct shm_segment {
+    int npages;
+    int *frames;
+} shm_segment_t;
+
+// A range of a process's Region 1 that maps a shared segment
+typedef struct shm_map {
+    list_node_t node;  // Node in the process's shm_maps list
+    int vpn;           // First Region 1 page of the mapping
+    int npages;        // Number of pages mapped
+} shm_map_t;
+
+#define shm_map_from_node(ptr) container_of(ptr, shm_map_t, node)
+
+/**
+ * Create a zero filled shared segment of at least size bytes
+ *
+ * @param shm_idp Where to store the id of the new segment
+ * @param size Size of the segment in bytes, rounded up to whole pages
+ * @return SUCCESS, or ERROR on a bad size or when out of frames or ids
+ */
+int shm_create(int *shm_idp, int size);
+
+/**
+ * Map a shared segment into a free range of the current process's Region 1
+ *
+ * The range is placed by find_free_range, between the break and the stack. Each mapped page takes a
+ * reference on its frame, so the mapping outlives a Reclaim of the segment.
+ *
+ * @param shm_id Id of the segment
+ * @param addrp Where to store the address the segment was mapped at
+ * @return SUCCESS, or ERROR on a bad id or when there is no room
+ */
+int shm_attach(int shm_id, void **addrp);
+
+/**
+ * Drop the segment's references on its frames and free it
+ *
+ * @param seg Segment being reclaimed
+ */
+void shm_destroy(shm_segment_t *seg);
+
+/**
+ * Check whether a Region 1 page of proc belongs to a shared mapping
+ *
+ * @param proc Process to check
+ * @param vpn Region 1 page number
+ * @return true if the page is shared
+ */
+bool shm_is_shared_page(pcb_t *proc, int vpn);
+
+/**
+ * Give child a copy of parent's shared mapping ranges, used by Fork
+ *
+ * @return SUCCESS, or ERROR if a range could not be allocated
+ */
+int shm_copy_maps(pcb_t *parent, pcb_t *child);
+
+/**
+ * Forget all of proc's shared mapping ranges, the frames are released with the page table
+ *
+ * @param proc Process whose user space is being torn down
+ */
+void shm_release_maps(pcb_t *proc);
+
+#endif /* _SHM_H_ */
@@ -0,0 +1,192 @@
+/**
+ * Date: 5/23/25
+ * File: swap.c
+ * Description: Clock pager implementation for Yalnix OS
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <yalnix.h>
+#include <ykernel.h>
+
+#include "swap.h"
+#include "frames.h"
+#include "memory.h"
+
+static int swap_fd = -1;
+static char slot_used[SWAP_SLOTS];
+static int clock_hand = 0;
+// Bumped at each syscall and page fault, pages stamped with the current value are pinned
+static unsigned int pin_trap = 1;
+
+static int swap_io(int slot, int pfn, bool out);
+
+void swap_init(void){
+    TracePrintf(1, "Enter swap_init.\n");
+    swap_fd = open(SWAP_FILE, O_RDWR | O_CREAT, 0600);
+    if(swap_fd < 0){
+        TracePrintf(0, "swap_init: could not open %s, paging out is disabled.\n", SWAP_FILE);
+    }
+    TracePrintf(1, "Exit swap_init.\n");
+}
+
+// Copies one page between a frame and a swap slot through the mapping window
+static int swap_io(int slot, int pfn, bool out){
+    void *page = kmap_frame(pfn);
+    lseek(swap_fd, slot * PAGESIZE, SEEK_SET);
+    int rc = out ? write(swap_fd, page, PAGESIZE) : read(swap_fd, page, PAGESIZE);
+    kunmap_frame(page);
+    return rc == PAGESIZE ? SUCCESS : ERROR;
+}
+
+int swap_evict(void){
+    TracePrintf(1, "Enter swap_evict.\n");
+    if(swap_fd < 0) return ERROR;
+
+    int slot = 0;
+    while(slot < SWAP_SLOTS && slot_used[slot]) slot++;
+    if(slot == SWAP_SLOTS){
+        TracePrintf(0, "swap_evict: ERROR: the swap file is full\n");
+        return ERROR;
+    }
+
+    // Two full turns are enough to revoke every page and then find one still revoked
+    for(int scanned = 0; scanned < 2 * frame_count; scanned++){
+        int pfn = clock_hand;
+        clock_hand = (clock_hand + 1) % frame_count;
+
+        // Only unshared pages with a known owner can be paged out
+        frame_owner_t *owner = &frame_owners[pfn];
+        if(owner->proc == NULL || frame_bitMap[pfn] != 1) continue;
+
+        pte_t *entry = &owner->proc->region1_pt[owner->vpn];
+        page_meta_t *meta = &owner->proc->cold->page_meta[owner->vpn];
+        bool current = owner->proc == current_process;
+        if(meta->futex_waiters > 0 || (current && meta->kernel_pin == pin_trap)) continue;
+        if(!entry->valid && !meta->revoked) continue;
+        if(entry->valid){
+            // Second chance, the next touch will fault and mark it as used again
+            entry->valid = 0;
+            meta->revoked = true;
+            if(current) WriteRegister(REG_TLB_FLUSH, VMEM_1_BASE + (owner->vpn << PAGESHIFT));
+            continue;
+        }
+
+        if(swap_io(slot, pfn, true) == ERROR){
+            TracePrintf(0, "swap_evict: ERROR: writing frame %d to slot %d failed\n", pfn, slot);
+            return ERROR;
+        }
+        slot_used[slot] = 1;
+        meta->revoked = false;
+        meta->sampled = false;
+        meta->swap_slot = slot;
+        entry->pfn = 0;
+        TracePrintf(1, "Exit swap_evict, page %d of process %d went to slot %d, frame %d is free.\n", owner->vpn, owner->proc->pid, slot, pfn);
+        // The frame goes straight to the caller, so it keeps its single reference
+        owner->proc = NULL;
+        return pfn;
+    }
+    TracePrintf(0, "swap_evict: ERROR: no page could be paged out\n");
+    return ERROR;
+}
+
+void swap_pin(pcb_t *proc, int vpn){
+    if(proc == current_process) proc->cold->page_meta[vpn].kernel_pin = pin_trap;
+}
+
+void swap_unpin_all(void){
+    pin_trap++;
+    // Never reuse the stamp a fresh page_meta starts with
+    if(pin_trap == 0) pin_trap++;
+}
+
+int swap_fault(int vpn){
+    pcb_t *curr = current_process;
+    if(!swap_holds(curr, vpn)) return ERROR;
+    // A revoked page only needs its valid bit back, a swapped one has to be read in.
+    // Touching a page the sampler hid is bookkeeping, not a fault the process caused.
+    page_meta_t *meta = &curr->cold->page_meta[vpn];
+    if(!meta->revoked) curr->cold->major_faults++;
+    else if(!meta->sampled) curr->cold->minor_faults++;
+    return swap_settle(curr, vpn);
+}
+
+void swap_sample_working_sets(void){
+    TracePrintf(1, "Enter swap_sample_working_sets.\n");
+    for(int pfn = 0; pfn < frame_count; pfn++){
+        if(frame_owners[pfn].proc != NULL) frame_owners[pfn].proc->cold->working_set = 0;
+    }
+    bool revoked_current = false;
+    for(int pfn = 0; pfn < frame_count; pfn++){
+        frame_owner_t *owner = &frame_owners[pfn];
+        if(owner->proc == NULL) continue;
+        pte_t *entry = &owner->proc->region1_pt[owner->vpn];
+        if(!entry->valid) continue;
+        // Valid means it was touched since it was last revoked
+        owner->proc->cold->working_set++;
+        entry->valid = 0;
+        owner->proc->cold->page_meta[owner->vpn].revoked = true;
+        owner->proc->cold->page_meta[owner->vpn].sampled = true;
+        if(owner->proc == current_process) revoked_current = true;
+    }
+    // The clock only interrupts user mode, so the kernel is not in the middle of using any of these pages.
+    // Other processes drop their Region 1 TLB entries when they switch back in, the running one has to now.
+    if(revoked_current) WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
+    TracePrintf(1, "Exit swap_sample_working_sets.\n");
+}
+
+int swap_settle(pcb_t *proc, int vpn){
+    pte_t *entry = &proc->region1_pt[vpn];
+    page_meta_t *meta = &proc->cold->page_meta[vpn];
+
+    if(meta->revoked){
+        // The frame never left, it was only hidden to catch this access
+        meta->revoked = false;
+        meta->sampled = false;
+        entry->valid = 1;
+    } else if(meta->swap_slot != NO_SWAP_SLOT){
+        int pfn = allocate_frame();
+        if(pfn == ERROR) return ERROR;
+        if(swap_io(meta->swap_slot, pfn, false) == ERROR){
+            TracePrintf(0, "swap_settle: ERROR: reading slot %d back failed\n", meta->swap_slot);
+            free_frame(pfn);
+            return ERROR;
+        }
+        slot_used[meta->swap_slot] = 0;
+        meta->swap_slot = NO_SWAP_SLOT;
+        entry->pfn = pfn;
+        entry->valid = 1;
+        frame_set_owner(pfn, proc, vpn);
+        TracePrintf(1, "swap_settle: page %d of process %d is back in frame %d\n", vpn, proc->pid, pfn);
+    } else {
+        return entry->valid ? SUCCESS : ERROR;
+    }
+
+    if(proc == current_process){
+        swap_pin(proc, vpn);
+        WriteRegister(REG_TLB_FLUSH, VMEM_1_BASE + (vpn << PAGESHIFT));
+    }
+    return SUCCESS;
+}
+
+void swap_discard(pcb_t *proc, int vpn){
+    pte_t *entry = &proc->region1_pt[vpn];
+    page_meta_t *meta = &proc->cold->page_meta[vpn];
+    if(meta->revoked){
+        free_frame(entry->pfn);
+        meta->sampled = false;
+    } else if(meta->swap_slot != NO_SWAP_SLOT){
+        slot_used[meta->swap_slot] = 0;
+    } else {
+        return;
+    }
+    meta->revoked = false;
+    meta->swap_slot = NO_SWAP_SLOT;
+    entry->pfn = 0;
+    entry->prot = 0;
+}
+
+bool swap_holds(pcb_t *proc, int vpn){
+    page_meta_t *meta = &proc->cold->page_meta[vpn];
+    return !proc->region1_pt[vpn].valid && (meta->revoked || meta->swap_slot != NO_SWAP_SLOT);
+}
@@ -0,0 +1,111 @@
+/**
+ * Date: 5/23/25
+ * File: swap.h
+ * Description: Pager that swaps Region 1 pages out to the DISK file for Yalnix OS
+ */
+
+#ifndef _SWAP_H_
+#define _SWAP_H_
+
+#include <hardware.h>
+#include "pcb.h"
+
+// Host file the swapped pages are written to
+#define SWAP_FILE "DISK"
+
+// Number of page sized slots in the swap file
+#define SWAP_SLOTS 1024
+
+// page_meta_t swap_slot value for a page that is not swapped out
+#define NO_SWAP_SLOT (-1)
+
+// Clock ticks between working set samples
+#define WSS_SAMPLE_TICKS 50
+
+// Side table kept next to a process's Region 1 page table, one entry per page
+typedef struct page_meta {
+    int swap_slot;  // Slot holding the page while it is swapped out, or NO_SWAP_SLOT
+    bool revoked;   // Still resident but made invalid by the clock hand to see if it gets touched
+    bool sampled;   // Revoked by the working set sampler rather than the pager, refaulting it is not counted
+    bool cow;       // Mapped read only to the zero page, gets a private frame on first write
+    int futex_waiters;  // Processes queued on a futex in this page, keyed by its frame so it cannot move
+    unsigned int kernel_pin;  // Trap in which the kernel last touched the page, see swap_pin
+} page_meta_t;
+
+/**
+ * Open the swap file, paging out is disabled if it cannot be opened
+ */
+void swap_init(void);
+
+/**
+ * Free a frame by paging out an unused Region 1 page, called when allocate_frame runs dry
+ *
+ * Runs the clock hand over the frame owner table. A page that has been
+ * touched since the last pass gets its access revoked as its second chance,
+ * a page that is still revoked when the hand comes back is written to a
+ * swap slot. Pages of the current process that the kernel pinned during
+ * this trap are skipped since the caller is still using them, and so are
+ * pages with futex waiters since their queue is keyed by the frame.
+ *
+ * @return The freed frame, already marked as allocated, or ERROR
+ */
+int swap_evict(void);
+
+/**
+ * Keep a page of the current process resident for the rest of this trap
+ *
+ * Called on every page the kernel reads or writes on the process's behalf,
+ * so allocating a frame for the next page cannot page it out underneath.
+ *
+ * @param proc The current process
+ * @param vpn Region 1 page the kernel is using
+ */
+void swap_pin(pcb_t *proc, int vpn);
+
+/**
+ * Drop every pin, called as a trap that may touch user memory begins
+ */
+void swap_unpin_all(void);
+
+/**
+ * Resolve a fault on a revoked or swapped out page of the current process
+ *
+ * @param vpn Region 1 page that faulted
+ * @return SUCCESS if the page is mapped again, ERROR if the pager does not own it
+ */
+int swap_fault(int vpn);
+
+/**
+ * Sample the working set of every process that owns frames
+ *
+ * Each owner's working_set becomes the number of its pages touched since
+ * the previous sample, then those pages are revoked again so the next
+ * sample can see which ones get touched. Refaults on sampled pages are not
+ * counted as minor faults. Called from the clock handler, which only
+ * interrupts user mode, so the running process is sampled too.
+ */
+void swap_sample_working_sets(void);
+
+/**
+ * Make a page of proc resident and valid again, for kernel code that needs its contents
+ *
+ * @return SUCCESS, or ERROR if the page could not be brought back in
+ */
+int swap_settle(pcb_t *proc, int vpn);
+
+/**
+ * Drop a revoked frame or swap slot of a page that is being unmapped
+ *
+ * @param proc Process the page belongs to
+ * @param vpn Region 1 page being unmapped
+ */
+void swap_discard(pcb_t *proc, int vpn);
+
+/**
+ * Check whether the pager holds a non-valid page of proc
+ *
+ * @return true if the page is revoked or swapped out
+ */
+bool swap_holds(pcb_t *proc, int vpn);
+
+#endif /* _SWAP_H_ */
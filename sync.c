@@ -3,6 +3,7 @@
 #include <ykernel.h>
 
 #include "sync.h"
+#include "sched.h"
 
 sync_obj_t *sync_table[MAX_SYNCS];
 int global_sync_counter = 0;
@@ -38,6 +39,18 @@ int InitSyncObject(sync_type_t type, void *object){
         case CVAR:
             new_sync->object.cvar = (cvar_t *)object;
             break;
+        case RWLOCK:
+            new_sync->object.rwlock = (rwlock_t *)object;
+            break;
+        case SEMAPHORE:
+            new_sync->object.sem = (semaphore_t *)object;
+            break;
+        case BARRIER:
+            new_sync->object.barrier = (barrier_t *)object;
+            break;
+        case SHM:
+            new_sync->object.shm = (shm_segment_t *)object;
+            break;
         default:
             // This should never be reached in normal running
             free(new_sync);
@@ -59,7 +72,8 @@ int GetCheckSync(int id, sync_type_t expected, sync_obj_t **out_sync){
 
     sync_obj_t *sync = sync_table[id];
     if (sync->type != expected) {
-        TracePrintf(1, "ERROR, Sync object ID %d is not of expected type %d (got type %d", id, expected, sync->type);
+        TracePrintf(1, "ERROR, Sync object ID %d is not of expected type %d (got type %d).\n", id, expected, sync->type);
+        return ERROR;
     }
 
     *out_sync = sync;
@@ -67,7 +81,15 @@ int GetCheckSync(int id, sync_type_t expected, sync_obj_t **out_sync){
 }
 
 int SyncInitPipe(int *pipe_idp){
-    TracePrintf(1, "Enter SyncInitPipe.\n");
+    return SyncInitPipeSized(pipe_idp, PIPE_BUFFER_LEN);
+}
+
+int SyncInitPipeSized(int *pipe_idp, int capacity){
+    TracePrintf(1, "Enter SyncInitPipeSized with capacity %d.\n", capacity);
+    if(capacity <= 0 || capacity > PIPE_MAX_CAPACITY){
+        TracePrintf(1, "ERROR, pipe capacity %d is outside of (0, %d].\n", capacity, PIPE_MAX_CAPACITY);
+        return ERROR;
+    }
     // If there are too many syncing objects return an error
     if(global_sync_counter >= MAX_SYNCS){
         TracePrintf(1, "ERROR, the maximum number of synchronization constants has been reached.\n");
@@ -77,24 +99,35 @@ int SyncInitPipe(int *pipe_idp){
     pipe_t *new_pipe = (pipe_t *)malloc(sizeof(pipe_t));
     if(new_pipe == NULL){
         TracePrintf(1, "ERROR, the new pipe could not be allocated.\n");
+        return ERROR;
     }
+    new_pipe->buffer = (char *)malloc(capacity);
+    if(new_pipe->buffer == NULL){
+        TracePrintf(1, "ERROR, the %d byte pipe buffer could not be allocated.\n", capacity);
+        free(new_pipe);
+        return ERROR;
+    }
+    new_pipe->capacity = capacity;
     new_pipe->read_pos = 0;
     new_pipe->write_pos = 0;
     new_pipe->bytes_in_buffer = 0;
     list_init(&new_pipe->readers);
     list_init(&new_pipe->writers);
+    list_init(&new_pipe->pollers);
     new_pipe->open_for_read = true;
     new_pipe->open_for_write = true;
+    new_pipe->nonblocking = false;
     // Init the sync object with InitSyncObject
     int rc = InitSyncObject(PIPE, (void *)new_pipe);
     if(rc == ERROR){
         TracePrintf(1, "ERROR, there was an issue with allocating the synchonization object.\n");
+        free(new_pipe->buffer);
         free(new_pipe);
         return ERROR;
     }
     // Return the return of InitSyncObject and set the idp value to the returned id
     *pipe_idp = rc;
-    TracePrintf(1, "Exit SyncInitPipe.\n");
+    TracePrintf(1, "Exit SyncInitPipeSized.\n");
     return SUCCESS;
 }
 
@@ -128,11 +161,15 @@ int SyncReadPipe(int pipe_id, void *buf, int len){
         // set the pcb's read length to len
         // Add the process to the pipe's read queue
         // When a writer eventually writes to this pipe the writer will make sure the reader is woken, written to, and put into the ready queue
+    if(pipe->bytes_in_buffer == 0 && pipe->nonblocking) {
+        TracePrintf(1, "Exit SyncReadPipe, the pipe is empty and non-blocking.\n");
+        return WOULD_BLOCK;
+    }
     if(pipe->bytes_in_buffer == 0) {
         TracePrintf(1, "Pipe is empty, blocking process %d.\n", curr->pid);
-        curr->waiting_pipe_id = pipe_id;
-        curr->pipe_buffer = buf;
-        curr->pipe_len = len;
+        curr->cold->waiting_pipe_id = pipe_id;
+        curr->cold->pipe_buffer = buf;
+        curr->cold->pipe_len = len;
 
         insert_tail(&pipe->readers, &curr->queue_node);
         curr->state = PROCESS_BLOCKED;
@@ -147,19 +184,91 @@ int SyncReadPipe(int pipe_id, void *buf, int len){
     // copy bytes to read bytes from buffer to buf
     for (int i = 0; i < to_read; i++){
         dest[i] = pipe->buffer[pipe->read_pos];
-        pipe->read_pos = (pipe->read_pos + 1) % PIPE_BUFFER_LEN;
+        pipe->read_pos = (pipe->read_pos + 1) % pipe->capacity;
     }
-    
-    curr->user_context.regs[0] = to_read;
 
     pipe->bytes_in_buffer -= to_read;
     SyncDrainWriters(pipe);
+    // Space opened up, let any pollers recheck
+    SyncPollNotify(&pipe->pollers);
     // return bytes to read
 
     TracePrintf(1, "Exit SyncReadPipe.\n");
+    return to_read;
+}
+
+int SyncReadPipeTimed(int pipe_id, void *buf, int len, int ticks){
+    if(ticks <= 0){
+        TracePrintf(1, "ERROR, a timed read needs a positive timeout, got %d.\n", ticks);
+        return ERROR;
+    }
+    int rc = SyncReadPipe(pipe_id, buf, len);
+    if(rc == PCB_BLOCKED){
+        add_to_timeout_queue(current_process, ticks, &sync_table[pipe_id]->object.pipe->readers);
+    }
+    return rc;
+}
+
+int SyncPipeSetFlags(int pipe_id, int flags){
+    TracePrintf(1, "Enter SyncPipeSetFlags.\n");
+    sync_obj_t *sync;
+    if (GetCheckSync(pipe_id, PIPE, &sync) == ERROR){
+        return ERROR;
+    }
+    if (flags & ~PIPE_NONBLOCK){
+        TracePrintf(1, "ERROR, unknown pipe flags %x.\n", flags);
+        return ERROR;
+    }
+
+    sync->object.pipe->nonblocking = (flags & PIPE_NONBLOCK) != 0;
+    TracePrintf(1, "Exit SyncPipeSetFlags, pipe %d is now %s.\n", pipe_id, sync->object.pipe->nonblocking ? "non-blocking" : "blocking");
     return SUCCESS;
 }
 
+// Moves up to n bytes from the src ring straight into the dst ring without blocking,
+// then lets the drain logic refill src from its writers and hand dst to its readers
+int SyncPipeSplice(int src_id, int dst_id, int n){
+    TracePrintf(1, "Enter SyncPipeSplice.\n");
+    sync_obj_t *src_sync, *dst_sync;
+    if (GetCheckSync(src_id, PIPE, &src_sync) == ERROR || GetCheckSync(dst_id, PIPE, &dst_sync) == ERROR){
+        return ERROR;
+    }
+    if (src_id == dst_id || n < 0){
+        TracePrintf(1, "ERROR, cannot splice %d bytes from pipe %d to pipe %d.\n", n, src_id, dst_id);
+        return ERROR;
+    }
+    pipe_t *src = src_sync->object.pipe;
+    pipe_t *dst = dst_sync->object.pipe;
+    if (!dst->open_for_write){
+        TracePrintf(1, "ERROR, the destination pipe is not open for writing.\n");
+        return ERROR;
+    }
+
+    // Pull in anything blocked writers are still holding so it can be forwarded too
+    if (src->writers.count != 0) SyncDrainWriters(src);
+
+    int space = dst->capacity - dst->bytes_in_buffer;
+    int moved = (n < src->bytes_in_buffer) ? n : src->bytes_in_buffer;
+    if (moved > space) moved = space;
+
+    for (int i = 0; i < moved; i++){
+        dst->buffer[dst->write_pos] = src->buffer[src->read_pos];
+        src->read_pos = (src->read_pos + 1) % src->capacity;
+        dst->write_pos = (dst->write_pos + 1) % dst->capacity;
+    }
+    src->bytes_in_buffer -= moved;
+    dst->bytes_in_buffer += moved;
+
+    // src gained space and dst gained data
+    if (src->writers.count != 0) SyncDrainWriters(src);
+    SyncDrainReaders(dst);
+    SyncPollNotify(&src->pollers);
+    SyncPollNotify(&dst->pollers);
+
+    TracePrintf(1, "Exit SyncPipeSplice, moved %d bytes from pipe %d to pipe %d.\n", moved, src_id, dst_id);
+    return moved;
+}
+
 void SyncDrainWriters(pipe_t *pipe) {
     TracePrintf(1, "Attempting to drain the writers queue for the pipe.\n");
     while(1) {
@@ -171,34 +280,35 @@ void SyncDrainWriters(pipe_t *pipe) {
         }
 
         pcb_t *writer = pcb_from_queue_node(node);
-        char *src = (char *)writer->pipe_buffer;
-        int len = writer->pipe_len;
+        char *src = (char *)writer->cold->pipe_buffer;
+        int len = writer->cold->pipe_len;
         int written = 0;
 
-        while(pipe->bytes_in_buffer < PIPE_BUFFER_LEN && writer->write_loc < len){
-            pipe->buffer[pipe->write_pos] = src[writer->write_loc];
-            pipe->write_pos = (pipe->write_pos + 1) % PIPE_BUFFER_LEN;
+        while(pipe->bytes_in_buffer < pipe->capacity && writer->cold->write_loc < len){
+            pipe->buffer[pipe->write_pos] = src[writer->cold->write_loc];
+            pipe->write_pos = (pipe->write_pos + 1) % pipe->capacity;
             pipe->bytes_in_buffer++;
-            writer->write_loc++;
+            writer->cold->write_loc++;
             written++;
         }
 
         TracePrintf(1, "Writer %d wrote %d bytes to pipe.\n", writer->pid, written);
-        if (writer->write_loc < len) {
+        if (writer->cold->write_loc < len) {
            insert_head(&pipe->writers, node);
            TracePrintf(1, "Writer %d did not complete it's write, requeued.\n", writer->pid);
            if (pipe->bytes_in_buffer != 0 && pipe->readers.count != 0) SyncDrainReaders(pipe);
            return;
         }
 
-        writer->pipe_buffer = NULL;
-        writer->pipe_len = 0;
-        writer->write_loc = 0;
-        writer->waiting_pipe_id = -1;
+        writer->cold->pipe_buffer = NULL;
+        writer->cold->pipe_len = 0;
+        writer->cold->write_loc = 0;
+        writer->cold->waiting_pipe_id = -1;
         writer->state = PROCESS_DEFAULT;
-        writer->user_context.regs[0] = len;
+        writer->cold->user_context.regs[0] = len;
 
         add_to_ready_queue(writer);
+        SyncNoteWake(writer);
     }
 }
 
@@ -208,32 +318,33 @@ void SyncDrainReaders(pipe_t *pipe){
         list_node_t *node = pop(&pipe->readers);
         if (node == NULL){
             TracePrintf(1,"Exit, SyncDrainReaders, the readers queue is drained.\n");
-            if (pipe->bytes_in_buffer < PIPE_BUFFER_LEN && pipe->readers.count != 0) SyncDrainWriters(pipe);
+            if (pipe->bytes_in_buffer < pipe->capacity && pipe->readers.count != 0) SyncDrainWriters(pipe);
             return;
         }
 
         pcb_t *reader = pcb_from_queue_node(node);
 
-        char *dest = (char *)reader->pipe_buffer;
-        int req = reader->pipe_len;
+        char *dest = (char *)reader->cold->pipe_buffer;
+        int req = reader->cold->pipe_len;
         int avl = pipe->bytes_in_buffer;
         int to_read = (req < avl) ? req : avl;
 
         for (int i = 0; i < to_read; i++){
             dest[i] = pipe->buffer[pipe->read_pos];
-            pipe->read_pos = (pipe->read_pos + 1) % PIPE_BUFFER_LEN;
+            pipe->read_pos = (pipe->read_pos + 1) % pipe->capacity;
             pipe->bytes_in_buffer--;
         }
         
-        reader->user_context.regs[0] = to_read;
-        reader->waiting_pipe_id = -1;
+        reader->cold->user_context.regs[0] = to_read;
+        reader->cold->waiting_pipe_id = -1;
         reader->state = PROCESS_DEFAULT;
         add_to_ready_queue(reader);
+        SyncNoteWake(reader);
 
         TracePrintf(1, "Reader %d read %d bytes.\n", reader->pid, to_read);
     }
     TracePrintf(1, "Exit SyncDrainReaders, the pipe buffer has been drained.\n");
-    if (pipe->bytes_in_buffer < PIPE_BUFFER_LEN && pipe->readers.count != 0) SyncDrainWriters(pipe);
+    if (pipe->bytes_in_buffer < pipe->capacity && pipe->readers.count != 0) SyncDrainWriters(pipe);
 }
 
 // Just kidding this is blocking now
@@ -252,39 +363,65 @@ int SyncWritePipe(int pipe_id, void *buf, int len){
         return ERROR;
     }
 
-    int space = PIPE_BUFFER_LEN - pipe->bytes_in_buffer;
+    int space = pipe->capacity - pipe->bytes_in_buffer;
     char *src = (char *)buf;
     int written = 0;
     pcb_t *writer = current_process;
 
-    writer->write_loc = 0;
-    while(written < space && writer->write_loc < len){
-        pipe->buffer[pipe->write_pos] = src[writer->write_loc];
-        pipe->write_pos = (pipe->write_pos + 1) % PIPE_BUFFER_LEN;
+    writer->cold->write_loc = 0;
+    while(written < space && writer->cold->write_loc < len){
+        pipe->buffer[pipe->write_pos] = src[writer->cold->write_loc];
+        pipe->write_pos = (pipe->write_pos + 1) % pipe->capacity;
         pipe->bytes_in_buffer++;
-        writer->write_loc++;
+        writer->cold->write_loc++;
         written++;
         
     }
  
     TracePrintf(1, "Writer %d wrote %d bytes to pipe.\n", writer->pid, written);
-    if (writer->write_loc < len) {
-        writer->pipe_buffer = buf;
-        writer->pipe_len = len;
-        writer->waiting_pipe_id = pipe_id;
+
+    // A non-blocking writer never queues: hand what is buffered to waiting readers and keep
+    // filling until the ring stays full, then report how much was accepted
+    if (writer->cold->write_loc < len && pipe->nonblocking) {
+        while (writer->cold->write_loc < len && pipe->readers.count != 0) {
+            SyncDrainReaders(pipe);
+            int before = writer->cold->write_loc;
+            while (pipe->bytes_in_buffer < pipe->capacity && writer->cold->write_loc < len) {
+                pipe->buffer[pipe->write_pos] = src[writer->cold->write_loc];
+                pipe->write_pos = (pipe->write_pos + 1) % pipe->capacity;
+                pipe->bytes_in_buffer++;
+                writer->cold->write_loc++;
+            }
+            if (writer->cold->write_loc == before) break;
+        }
+        int accepted = writer->cold->write_loc;
+        writer->cold->write_loc = 0;
+
+        SyncDrainReaders(pipe);
+        SyncPollNotify(&pipe->pollers);
+        TracePrintf(1, "Non-blocking writer %d had %d of %d bytes accepted.\n", writer->pid, accepted, len);
+        return accepted > 0 ? accepted : WOULD_BLOCK;
+    }
+
+    if (writer->cold->write_loc < len) {
+        writer->cold->pipe_buffer = buf;
+        writer->cold->pipe_len = len;
+        writer->cold->waiting_pipe_id = pipe_id;
 
         writer->state = PROCESS_BLOCKED;
         insert_tail(&pipe->writers, &writer->queue_node);
         TracePrintf(1, "Writer %d did not complete it's write, requeued.\n", writer->pid);
         
         SyncDrainReaders(pipe);
+        SyncPollNotify(&pipe->pollers);
 
         return PCB_BLOCKED;
     }
 
-    writer->user_context.regs[0] = len;
     SyncDrainReaders(pipe);
-    return SUCCESS;
+    // Data arrived, let any pollers recheck
+    SyncPollNotify(&pipe->pollers);
+    return len;
 }
 
 int SyncInitLock(int *lock_idp){
@@ -302,6 +439,7 @@ int SyncInitLock(int *lock_idp){
     new_lock->locked = false;
     new_lock->owner = NULL;
     list_init(&new_lock->waiters);
+    new_lock->held_node.prev = new_lock->held_node.next = NULL;
     // Init the sync object with InitSyncObject
     int rc = InitSyncObject(LOCK, (void *)new_lock);
     if(rc == ERROR){
@@ -334,17 +472,20 @@ int SyncLockAcquire(int lock_id){
     if(!lock->locked){
         lock->locked = true;
         lock->owner = current_process;
+        insert_tail(&current_process->cold->held_locks, &lock->held_node);
         return SUCCESS;
     } 
 
     
     // If lock is held
-    // Add the pcb to the queue lock
+    // Add the pcb to the queue lock in priority order
     // set the pcbs waiting lock
     // block the current process
-    insert_tail(&lock->waiters, &current_process->queue_node);
+    // lend the waiter's priority to the owner (and whoever the owner is waiting on)
+    insert_by_priority(&lock->waiters, current_process);
     current_process->state = PROCESS_BLOCKED;
-    current_process->waiting_lock_id = lock_id;
+    current_process->cold->waiting_lock_id = lock_id;
+    SyncBoostOwner(lock, current_process->priority);
     
     return PCB_BLOCKED;
 
@@ -369,27 +510,164 @@ int SyncLockRelease(int lock_id){
         return ERROR;
     }
 
+    // Hand the lock to the next waiter (or unlock it) and drop anything inherited through it
+    SyncLockHandoff(lock);
+    SyncRestorePriority(curr);
+    TracePrintf(1, "Exit SyncLockRelease.\n");
+    return SUCCESS;
+
+}
+
+int SyncLockAcquireTimed(int lock_id, int ticks){
+    if(ticks <= 0){
+        TracePrintf(1, "ERROR, a timed acquire needs a positive timeout, got %d.\n", ticks);
+        return ERROR;
+    }
+    int rc = SyncLockAcquire(lock_id);
+    if(rc == PCB_BLOCKED){
+        add_to_timeout_queue(current_process, ticks, &sync_table[lock_id]->object.lock->waiters);
+    }
+    return rc;
+}
+
+void SyncNoteWake(pcb_t *woken){
+    // Only the latest wake is kept, it is the peer the waker is most likely to wait on next
+    if(current_process != NULL && woken != current_process) current_process->handoff = woken;
+}
+
+void SyncLockHandoff(lock_t *lock){
+    // Take the lock off of the old owner's held list
+    if(lock->owner != NULL){
+        list_remove(&lock->owner->cold->held_locks, &lock->held_node);
+    }
+
     // Check if there are waiters
-        // If so give the lock to the next waiter
+        // If so give the lock to the next waiter (the highest priority one)
         // null the waiter's waiting lock
         // Set the next waiter to ready
     if(lock->waiters.count != 0){
         pcb_t *next = pcb_from_queue_node(pop(&lock->waiters));
         next->state = PROCESS_DEFAULT;
-        next->waiting_lock_id = -1;
+        next->cold->waiting_lock_id = -1;
 
-        add_to_ready_queue(next);
         lock->owner = next;
-        TracePrintf(1, "Exit SyncLockRelease, the next process waiting was given the lock.\n");
-        return SUCCESS;
+        insert_tail(&next->cold->held_locks, &lock->held_node);
+        // The new owner inherits from whoever is still waiting behind it
+        SyncRestorePriority(next);
+        add_to_ready_queue(next);
+        SyncNoteWake(next);
+        TracePrintf(1, "Lock handed off to process %d.\n", next->pid);
+        return;
     }
 
     // else set locked to false and owner to NULL
     lock->locked = false;
     lock->owner = NULL;
-    TracePrintf(1, "Exit SyncLockRelease, there were no processes waiting on this lock.\n");
-    return 0;
+    TracePrintf(1, "There were no processes waiting on this lock.\n");
+}
+
+bool SyncOwnsLock(int lock_id){
+    sync_obj_t *sync;
+    if (GetCheckSync(lock_id, LOCK, &sync) == ERROR){
+        return false;
+    }
+    return sync->object.lock->owner == current_process;
+}
+
+void SyncBoostOwner(lock_t *lock, int priority){
+    lock_t *first = lock;
+    // Follow the chain of owners: the owner of this lock may itself be blocked on another lock
+    while(lock != NULL && lock->owner != NULL && lock->owner->priority < priority){
+        pcb_t *owner = lock->owner;
+        TracePrintf(1, "Boosting lock owner %d to priority %d.\n", owner->pid, priority);
+        set_effective_priority(owner, priority);
+
+        // If the owner is not waiting on a lock the chain ends here
+        sync_obj_t *sync;
+        if(owner->cold->waiting_lock_id == -1 || GetCheckSync(owner->cold->waiting_lock_id, LOCK, &sync) == ERROR){
+            break;
+        }
+
+        // Keep the owner's spot in that lock's waiters in priority order, then move up the chain
+        lock = sync->object.lock;
+        list_remove(&lock->waiters, &owner->queue_node);
+        insert_by_priority(&lock->waiters, owner);
+    }
 
+    // The stride policy ignores priority, the new waiter's tickets go up the same chain instead
+    SyncRestoreChain(first);
+}
+
+void SyncRestorePriority(pcb_t *proc){
+    // The effective priority is the base priority or the best waiter on any lock still held,
+    // and every waiter on those locks lends its tickets (its own and whatever it was lent)
+    int priority = proc->base_priority;
+    int lent = 0;
+    list_node_t *head = &proc->cold->held_locks.head;
+    for(list_node_t *curr = head->next; curr != head; curr = curr->next){
+        lock_t *held = lock_from_held_node(curr);
+        if(held->waiters.count != 0){
+            int waiter_priority = pcb_from_queue_node(held->waiters.head.next)->priority;
+            if(waiter_priority > priority) priority = waiter_priority;
+        }
+        list_node_t *whead = &held->waiters.head;
+        for(list_node_t *w = whead->next; w != whead; w = w->next){
+            lent += pcb_from_queue_node(w)->tickets + pcb_from_queue_node(w)->lent_tickets;
+        }
+    }
+    set_effective_priority(proc, priority);
+    sched_lend_tickets(proc, lent);
+}
+
+void SyncRestoreChain(lock_t *lock){
+    // Recompute what each owner inherits, up the chain until one does not change.
+    // An acyclic chain is never longer than the number of locks, a deadlocked cycle would lend tickets around forever.
+    for(int hops = 0; hops < MAX_SYNCS && lock != NULL && lock->owner != NULL; hops++){
+        pcb_t *owner = lock->owner;
+        int before = owner->priority;
+        int lent_before = owner->lent_tickets;
+        SyncRestorePriority(owner);
+        if(owner->priority == before && owner->lent_tickets == lent_before) return;
+
+        sync_obj_t *sync;
+        if(owner->cold->waiting_lock_id == -1 || GetCheckSync(owner->cold->waiting_lock_id, LOCK, &sync) == ERROR){
+            return;
+        }
+        lock = sync->object.lock;
+        list_remove(&lock->waiters, &owner->queue_node);
+        insert_by_priority(&lock->waiters, owner);
+    }
+}
+
+void SyncReleaseHeld(pcb_t *proc){
+    // Each handoff takes the lock off of held_locks, so keep taking the first one
+    while(!list_is_empty(&proc->cold->held_locks)){
+        lock_t *lock = lock_from_held_node(peek(&proc->cold->held_locks));
+        TracePrintf(1, "Process %d exited holding a lock, handing it off.\n", proc->pid);
+        SyncLockHandoff(lock);
+    }
+
+    // RWLock holds it never released would keep everyone else out forever
+    while(!list_is_empty(&proc->cold->rw_holds)){
+        rw_hold_t *hold = rw_hold_from_proc_node(peek(&proc->cold->rw_holds));
+        rwlock_t *rwlock = hold->rwlock;
+        rwlock->readers -= hold->reads;
+        if(rwlock->writer == proc) rwlock->writer = NULL;
+        SyncRWLockDropHold(hold);
+        SyncRWLockGrant(rwlock);
+    }
+}
+
+int SyncSetPriority(int priority){
+    TracePrintf(1, "Enter SyncSetPriority.\n");
+    if(priority < MIN_PRIORITY || priority > MAX_PRIORITY){
+        TracePrintf(1, "ERROR, priority %d is outside of [%d, %d].\n", priority, MIN_PRIORITY, MAX_PRIORITY);
+        return ERROR;
+    }
+    current_process->base_priority = priority;
+    SyncRestorePriority(current_process);
+    TracePrintf(1, "Exit SyncSetPriority.\n");
+    return SUCCESS;
 }
 
 int SyncInitCvar(int *lock_idp){
@@ -447,28 +725,14 @@ int SyncCvarWait(int cvar_id, int lock_id){
     }
 
     // Release the lock as above, don't call release though since that would validate process and lock again
-    // Check if there are waiters
-        // If so give the lock to the next waiter
-        // null the waiter's waiting lock
-        // Set the next waiter to ready
-    if(lock->waiters.count != 0){
-        pcb_t *next = pcb_from_queue_node(pop(&lock->waiters));
-        next->state = PROCESS_DEFAULT;
-        next->waiting_lock_id = -1;
-
-        add_to_ready_queue(next);
-        lock->owner = next;
-              
-    } else {
-        lock->locked = false;
-        lock->owner = NULL;
-
-    }
+    SyncLockHandoff(lock);
+    SyncRestorePriority(curr);
 
     // Add the process to cvar's waiters
     insert_tail(&cvar->waiters, &curr->queue_node);
-    // Set the process's waiting cvar
-    curr->waiting_cvar_id = cvar_id;
+    // Set the process's waiting cvar, and the lock a signal should move it onto
+    curr->cold->waiting_cvar_id = cvar_id;
+    curr->cold->cvar_lock_id = lock_id;
     curr->state = PROCESS_BLOCKED;
     
     TracePrintf(1, "Exit SyncCvarWait.\n");
@@ -476,6 +740,58 @@ int SyncCvarWait(int cvar_id, int lock_id){
     
 }
 
+int SyncCvarWaitTimed(int cvar_id, int lock_id, int ticks){
+    if(ticks <= 0){
+        TracePrintf(1, "ERROR, a timed wait needs a positive timeout, got %d.\n", ticks);
+        return ERROR;
+    }
+    int rc = SyncCvarWait(cvar_id, lock_id);
+    if(rc == PCB_BLOCKED){
+        add_to_timeout_queue(current_process, ticks, &sync_table[cvar_id]->object.cvar->waiters);
+    }
+    return rc;
+}
+
+void SyncCancelWait(pcb_t *waiter){
+    TracePrintf(1, "Enter SyncCancelWait, process %d timed out.\n", waiter->pid);
+    // Both removals are O(1) unlinks of intrusive nodes
+    list_remove(waiter->wait_list, &waiter->queue_node);
+    remove_from_timeout_queue(waiter);
+
+    // The owner, and whoever it is blocked behind, may have been boosted on this waiter's behalf
+    sync_obj_t *sync;
+    if(waiter->cold->waiting_lock_id != -1 && GetCheckSync(waiter->cold->waiting_lock_id, LOCK, &sync) == SUCCESS){
+        SyncRestoreChain(sync->object.lock);
+    }
+    waiter->cold->waiting_lock_id = -1;
+    waiter->cold->waiting_cvar_id = -1;
+    waiter->cold->cvar_lock_id = -1;
+    waiter->cold->waiting_pipe_id = -1;
+    waiter->cold->pipe_buffer = NULL;
+    waiter->cold->pipe_len = 0;
+
+    waiter->timed_out = true;
+    waiter->state = PROCESS_DEFAULT;
+    add_to_ready_queue(waiter);
+    TracePrintf(1, "Exit SyncCancelWait.\n");
+}
+
+void SyncExpireTimeouts(void){
+    if(list_is_empty(timeout_queue)) return;
+
+    list_node_t *head = &timeout_queue->head;
+    list_node_t *curr = head->next;
+    while(curr != head){
+        list_node_t *next = curr->next;  // Store next before removal
+        pcb_t *waiter = pcb_from_timeout_node(curr);
+        waiter->timeout_ticks--;
+        if(waiter->timeout_ticks <= 0){
+            SyncCancelWait(waiter);
+        }
+        curr = next;
+    }
+}
+
 int SyncCvarSignal(int cvar_id){
     TracePrintf(1, "Enter SyncCvarSignal.\n");
     // Check to see if the cvar is valid
@@ -493,14 +809,10 @@ int SyncCvarSignal(int cvar_id){
         return 0;
     }
 
-    // Else pop the first waiter
+    // Else pop the first waiter and move it straight onto its lock
     pcb_t *next = pcb_from_queue_node(pop(&cvar->waiters));
     TracePrintf(1, "Removing proccess %d from the waiters list of cvar %d.\n", next->pid, cvar_id);
-    next->waiting_cvar_id = -1;
-    
-    // Add the waiter to ready
-    next->state = PROCESS_DEFAULT;
-    add_to_ready_queue(next);
+    SyncCvarMorph(next);
     
     TracePrintf(1, "Exit SyncCvarSignal.\n");
     return 0;
@@ -526,23 +838,468 @@ int SyncCvarBroadcast(int cvar_id){
 
     // while the queue is not empty
         // pop the first waiter
-        // add the waiter to ready
+        // move it onto its lock, only the one that gets the lock becomes ready
     while(cvar->waiters.count != 0){
         pcb_t *next = pcb_from_queue_node(pop(&cvar->waiters));
         TracePrintf(1, "Removing proccess %d from the waiters list of cvar %d.\n", next->pid, cvar_id);
-        next->waiting_cvar_id = -1;
+        SyncCvarMorph(next);
+    }
     
-        // Add the waiter to ready
+    TracePrintf(1, "Exit SyncCvarBroadcast.\n");
+    return 0;
+}
+
+void SyncCvarMorph(pcb_t *waiter){
+    // The wait itself is over, so a timed wait stops here, reacquiring the lock is not timed
+    waiter->cold->waiting_cvar_id = -1;
+    if(waiter->wait_list != NULL) remove_from_timeout_queue(waiter);
+
+    int lock_id = waiter->cold->cvar_lock_id;
+    waiter->cold->cvar_lock_id = -1;
+    sync_obj_t *sync;
+    if(GetCheckSync(lock_id, LOCK, &sync) == ERROR){
+        // The lock is gone, let the waiter find that out when it runs
+        waiter->state = PROCESS_DEFAULT;
+        add_to_ready_queue(waiter);
+        return;
+    }
+    lock_t *lock = sync->object.lock;
+
+    // A free lock goes to the waiter right away
+    if(!lock->locked){
+        lock->locked = true;
+        lock->owner = waiter;
+        insert_tail(&waiter->cold->held_locks, &lock->held_node);
+        waiter->state = PROCESS_DEFAULT;
+        add_to_ready_queue(waiter);
+        SyncNoteWake(waiter);
+        TracePrintf(1, "Process %d woke from its cvar owning lock %d.\n", waiter->pid, lock_id);
+        return;
+    }
+
+    // Otherwise it stays blocked, now queued on the lock as if it had called Acquire
+    insert_by_priority(&lock->waiters, waiter);
+    waiter->cold->waiting_lock_id = lock_id;
+    SyncBoostOwner(lock, waiter->priority);
+    TracePrintf(1, "Process %d moved from its cvar onto lock %d.\n", waiter->pid, lock_id);
+}
+
+
+
+int SyncInitRWLock(int *rwlock_idp){
+    TracePrintf(1, "Enter SyncInitRWLock.\n");
+    // If there are too many syncing objects return an error
+    if(global_sync_counter >= MAX_SYNCS){
+        TracePrintf(1, "ERROR, the maximum number of synchronization constants has been reached.\n");
+        return ERROR;
+    }
+    // initialize the rwlock fields
+    rwlock_t *new_rwlock = (rwlock_t *)malloc(sizeof(rwlock_t));
+    if(new_rwlock == NULL){
+        TracePrintf(1, "ERROR, the new rwlock could not be allocated.\n");
+        return ERROR;
+    }
+    new_rwlock->readers = 0;
+    new_rwlock->writer = NULL;
+    list_init(&new_rwlock->waiters);
+    list_init(&new_rwlock->holds);
+    // Init the sync object with InitSyncObject
+    int rc = InitSyncObject(RWLOCK, (void *)new_rwlock);
+    if(rc == ERROR){
+        TracePrintf(1, "ERROR, there was an issue with allocating the synchonization object.\n");
+        free(new_rwlock);
+        return ERROR;
+    }
+    // Return the return of InitSyncObject and set the idp value to the returned id
+    *rwlock_idp = rc;
+    TracePrintf(1, "Exit SyncInitRWLock.\n");
+    return SUCCESS;
+}
+
+// Finds proc's hold on rwlock, creating an empty one if create is set
+static rw_hold_t *SyncRWLockHold(rwlock_t *rwlock, pcb_t *proc, bool create){
+    list_node_t *head = &proc->cold->rw_holds.head;
+    for(list_node_t *curr = head->next; curr != head; curr = curr->next){
+        rw_hold_t *hold = rw_hold_from_proc_node(curr);
+        if(hold->rwlock == rwlock) return hold;
+    }
+    if(!create) return NULL;
+
+    rw_hold_t *hold = (rw_hold_t *)malloc(sizeof(rw_hold_t));
+    if(hold == NULL) return NULL;
+    hold->rwlock = rwlock;
+    hold->proc = proc;
+    hold->reads = 0;
+    insert_tail(&proc->cold->rw_holds, &hold->proc_node);
+    insert_tail(&rwlock->holds, &hold->rwlock_node);
+    return hold;
+}
+
+void SyncRWLockDropHold(rw_hold_t *hold){
+    list_remove(&hold->proc->cold->rw_holds, &hold->proc_node);
+    list_remove(&hold->rwlock->holds, &hold->rwlock_node);
+    free(hold);
+}
+
+int SyncRWLockAcquire(int rwlock_id, bool write){
+    TracePrintf(1, "Enter SyncRWLockAcquire.\n");
+    // Check to see if the rwlock is valid
+        // If not throw and error
+    sync_obj_t *sync;
+    if (GetCheckSync(rwlock_id, RWLOCK, &sync) == ERROR){
+        return ERROR;
+    }
+    rwlock_t *rwlock = sync->object.rwlock;
+    pcb_t *curr = current_process;
+
+    if(rwlock->writer == curr){
+        TracePrintf(1, "ERROR, process %d already holds rwlock %d for writing.\n", curr->pid, rwlock_id);
+        return ERROR;
+    }
+
+    // A reader asking to write would wait on itself forever, a reader asking again already has it
+    rw_hold_t *hold = SyncRWLockHold(rwlock, curr, false);
+    if(hold != NULL && hold->reads > 0){
+        if(write){
+            TracePrintf(1, "ERROR, process %d holds rwlock %d for reading and cannot upgrade.\n", curr->pid, rwlock_id);
+            return ERROR;
+        }
+        // Queuing behind a waiting writer would deadlock, since that writer is waiting on this process
+        hold->reads++;
+        rwlock->readers++;
+        TracePrintf(1, "Exit SyncRWLockAcquire, process %d holds rwlock %d for reading %d times.\n", curr->pid, rwlock_id, hold->reads);
+        return SUCCESS;
+    }
+
+    // Holders are tracked from the start, so granting the lock later cannot fail
+    hold = SyncRWLockHold(rwlock, curr, true);
+    if(hold == NULL){
+        TracePrintf(1, "ERROR, the hold on rwlock %d could not be allocated.\n", rwlock_id);
+        return ERROR;
+    }
+
+    // Anyone already queued goes first, so a waiting writer is never starved by a stream of readers
+    if(rwlock->waiters.count == 0 && rwlock->writer == NULL){
+        // Readers share the lock, a writer needs it to itself
+        if(!write){
+            hold->reads++;
+            rwlock->readers++;
+            TracePrintf(1, "Exit SyncRWLockAcquire, %d readers now hold rwlock %d.\n", rwlock->readers, rwlock_id);
+            return SUCCESS;
+        }
+        if(rwlock->readers == 0){
+            rwlock->writer = curr;
+            TracePrintf(1, "Exit SyncRWLockAcquire, process %d holds rwlock %d for writing.\n", curr->pid, rwlock_id);
+            return SUCCESS;
+        }
+    }
+
+    // Otherwise queue up behind everyone else and block
+    curr->cold->rw_write = write;
+    curr->state = PROCESS_BLOCKED;
+    insert_tail(&rwlock->waiters, &curr->queue_node);
+    TracePrintf(1, "Exit SyncRWLockAcquire, process %d is blocked.\n", curr->pid);
+    return PCB_BLOCKED;
+}
+
+int SyncRWLockRelease(int rwlock_id){
+    TracePrintf(1, "Enter SyncRWLockRelease.\n");
+    // Check to see if the rwlock is valid
+        // If not throw and error
+    sync_obj_t *sync;
+    if (GetCheckSync(rwlock_id, RWLOCK, &sync) == ERROR){
+        return ERROR;
+    }
+    rwlock_t *rwlock = sync->object.rwlock;
+
+    // Drop whichever hold the process has, only its own read holds count
+    rw_hold_t *hold = SyncRWLockHold(rwlock, current_process, false);
+    if(rwlock->writer == current_process){
+        rwlock->writer = NULL;
+        if(hold != NULL && hold->reads == 0) SyncRWLockDropHold(hold);
+    } else if(hold != NULL && hold->reads > 0){
+        hold->reads--;
+        rwlock->readers--;
+        if(hold->reads == 0) SyncRWLockDropHold(hold);
+    } else {
+        TracePrintf(1, "ERROR, process %d does not hold rwlock %d.\n", current_process->pid, rwlock_id);
+        return ERROR;
+    }
+
+    SyncRWLockGrant(rwlock);
+    TracePrintf(1, "Exit SyncRWLockRelease.\n");
+    return SUCCESS;
+}
+
+void SyncRWLockGrant(rwlock_t *rwlock){
+    // Wake waiters from the head in arrival order
+        // a writer at the head only gets in once the lock is completely free
+        // a run of readers at the head all get in together
+    while(rwlock->waiters.count != 0 && rwlock->writer == NULL){
+        pcb_t *next = pcb_from_queue_node(peek(&rwlock->waiters));
+        if(next->cold->rw_write){
+            if(rwlock->readers != 0) return;
+            rwlock->writer = next;
+        } else {
+            // The hold was made when the reader queued
+            SyncRWLockHold(rwlock, next, false)->reads++;
+            rwlock->readers++;
+        }
+
+        pop(&rwlock->waiters);
         next->state = PROCESS_DEFAULT;
         add_to_ready_queue(next);
-    
+        TracePrintf(1, "Process %d was granted the rwlock for %s.\n", next->pid, next->cold->rw_write ? "writing" : "reading");
     }
-    
-    TracePrintf(1, "Exit SyncCvarBroadcast.\n");
-    
 }
 
+int SyncInitSem(int *sem_idp, int count){
+    TracePrintf(1, "Enter SyncInitSem.\n");
+    if(count < 0){
+        TracePrintf(1, "ERROR, a semaphore cannot start with a negative count %d.\n", count);
+        return ERROR;
+    }
+    // If there are too many syncing objects return an error
+    if(global_sync_counter >= MAX_SYNCS){
+        TracePrintf(1, "ERROR, the maximum number of synchronization constants has been reached.\n");
+        return ERROR;
+    }
+    // initialize the semaphore fields
+    semaphore_t *new_sem = (semaphore_t *)malloc(sizeof(semaphore_t));
+    if(new_sem == NULL){
+        TracePrintf(1, "ERROR, the new semaphore could not be allocated.\n");
+        return ERROR;
+    }
+    new_sem->count = count;
+    list_init(&new_sem->waiters);
+    // Init the sync object with InitSyncObject
+    int rc = InitSyncObject(SEMAPHORE, (void *)new_sem);
+    if(rc == ERROR){
+        TracePrintf(1, "ERROR, there was an issue with allocating the synchonization object.\n");
+        free(new_sem);
+        return ERROR;
+    }
+    // Return the return of InitSyncObject and set the idp value to the returned id
+    *sem_idp = rc;
+    TracePrintf(1, "Exit SyncInitSem.\n");
+    return SUCCESS;
+}
+
+int SyncSemWait(int sem_id, int n){
+    TracePrintf(1, "Enter SyncSemWait.\n");
+    // Check to see if the semaphore is valid
+        // If not throw and error
+    sync_obj_t *sync;
+    if (GetCheckSync(sem_id, SEMAPHORE, &sync) == ERROR){
+        return ERROR;
+    }
+    if(n <= 0){
+        TracePrintf(1, "ERROR, cannot wait for %d tokens.\n", n);
+        return ERROR;
+    }
+    semaphore_t *sem = sync->object.sem;
+
+    // Take the tokens right away if nobody is queued ahead and enough are available
+    if(sem->waiters.count == 0 && sem->count >= n){
+        sem->count -= n;
+        TracePrintf(1, "Exit SyncSemWait, took %d tokens, %d left.\n", n, sem->count);
+        return SUCCESS;
+    }
 
+    // Otherwise queue up and block, the poster hands the tokens over before waking us
+    pcb_t *curr = current_process;
+    curr->cold->sem_wanted = n;
+    curr->state = PROCESS_BLOCKED;
+    insert_tail(&sem->waiters, &curr->queue_node);
+    TracePrintf(1, "Exit SyncSemWait, process %d is blocked waiting for %d tokens.\n", curr->pid, n);
+    return PCB_BLOCKED;
+}
+
+int SyncSemPost(int sem_id, int n){
+    TracePrintf(1, "Enter SyncSemPost.\n");
+    // Check to see if the semaphore is valid
+        // If not throw and error
+    sync_obj_t *sync;
+    if (GetCheckSync(sem_id, SEMAPHORE, &sync) == ERROR){
+        return ERROR;
+    }
+    if(n <= 0){
+        TracePrintf(1, "ERROR, cannot post %d tokens.\n", n);
+        return ERROR;
+    }
+    semaphore_t *sem = sync->object.sem;
+    sem->count += n;
+
+    // Wake as many waiters as the count covers in one pass, in arrival order
+        // stop at the first one that cannot be satisfied so large requests are not starved
+    while(sem->waiters.count != 0){
+        pcb_t *next = pcb_from_queue_node(peek(&sem->waiters));
+        if(next->cold->sem_wanted > sem->count) break;
+
+        pop(&sem->waiters);
+        sem->count -= next->cold->sem_wanted;
+        next->cold->sem_wanted = 0;
+        next->state = PROCESS_DEFAULT;
+        add_to_ready_queue(next);
+        TracePrintf(1, "Process %d was given its tokens, %d left.\n", next->pid, sem->count);
+    }
+
+    TracePrintf(1, "Exit SyncSemPost.\n");
+    return SUCCESS;
+}
+
+int SyncInitBarrier(int *barrier_idp, int parties){
+    TracePrintf(1, "Enter SyncInitBarrier.\n");
+    if(parties <= 0){
+        TracePrintf(1, "ERROR, a barrier needs at least one party, got %d.\n", parties);
+        return ERROR;
+    }
+    // If there are too many syncing objects return an error
+    if(global_sync_counter >= MAX_SYNCS){
+        TracePrintf(1, "ERROR, the maximum number of synchronization constants has been reached.\n");
+        return ERROR;
+    }
+    // initialize the barrier fields
+    barrier_t *new_barrier = (barrier_t *)malloc(sizeof(barrier_t));
+    if(new_barrier == NULL){
+        TracePrintf(1, "ERROR, the new barrier could not be allocated.\n");
+        return ERROR;
+    }
+    new_barrier->parties = parties;
+    new_barrier->arrived = 0;
+    list_init(&new_barrier->waiters);
+    // Init the sync object with InitSyncObject
+    int rc = InitSyncObject(BARRIER, (void *)new_barrier);
+    if(rc == ERROR){
+        TracePrintf(1, "ERROR, there was an issue with allocating the synchonization object.\n");
+        free(new_barrier);
+        return ERROR;
+    }
+    // Return the return of InitSyncObject and set the idp value to the returned id
+    *barrier_idp = rc;
+    TracePrintf(1, "Exit SyncInitBarrier.\n");
+    return SUCCESS;
+}
+
+int SyncBarrierWait(int barrier_id){
+    TracePrintf(1, "Enter SyncBarrierWait.\n");
+    // Check to see if the barrier is valid
+        // If not throw and error
+    sync_obj_t *sync;
+    if (GetCheckSync(barrier_id, BARRIER, &sync) == ERROR){
+        return ERROR;
+    }
+    barrier_t *barrier = sync->object.barrier;
+    barrier->arrived++;
+
+    // Everyone but the last arriver blocks
+    if(barrier->arrived < barrier->parties){
+        pcb_t *curr = current_process;
+        curr->state = PROCESS_BLOCKED;
+        insert_tail(&barrier->waiters, &curr->queue_node);
+        TracePrintf(1, "Exit SyncBarrierWait, process %d is waiting (%d of %d).\n", curr->pid, barrier->arrived, barrier->parties);
+        return PCB_BLOCKED;
+    }
+
+    // The last arriver releases the whole phase in one pass and resets the barrier for the next one
+    while(barrier->waiters.count != 0){
+        pcb_t *next = pcb_from_queue_node(pop(&barrier->waiters));
+        next->state = PROCESS_DEFAULT;
+        add_to_ready_queue(next);
+    }
+    barrier->arrived = 0;
+    TracePrintf(1, "Exit SyncBarrierWait, process %d released the barrier.\n", current_process->pid);
+    return BARRIER_LAST;
+}
+
+int SyncPollScan(poll_entry_t *entries, int n){
+    // Fill in revents for every entry and count how many have something ready
+    int ready = 0;
+    for(int i = 0; i < n; i++){
+        poll_entry_t *e = &entries[i];
+        e->revents = 0;
+
+        sync_obj_t *sync;
+        if(e->type != POLL_PIPE || GetCheckSync(e->id, PIPE, &sync) == ERROR){
+            // Terminals have no kernel-side buffering yet, so they cannot be watched
+            e->revents = POLL_ERR;
+            ready++;
+            continue;
+        }
+
+        pipe_t *pipe = sync->object.pipe;
+        if((e->events & POLL_READ) && pipe->open_for_read && pipe->bytes_in_buffer > 0){
+            e->revents |= POLL_READ;
+        }
+        if((e->events & POLL_WRITE) && pipe->open_for_write && pipe->bytes_in_buffer < pipe->capacity){
+            e->revents |= POLL_WRITE;
+        }
+        if(e->revents != 0) ready++;
+    }
+    return ready;
+}
+
+void SyncPollRegister(poll_entry_t *entries, poll_node_t *nodes, int n){
+    // Put one node on each watched pipe so a change on any of them wakes this process
+    pcb_t *curr = current_process;
+    for(int i = 0; i < n; i++){
+        nodes[i].proc = curr;
+        nodes[i].node.next = nodes[i].node.prev = NULL;
+
+        sync_obj_t *sync;
+        if(GetCheckSync(entries[i].id, PIPE, &sync) == SUCCESS){
+            insert_tail(&sync->object.pipe->pollers, &nodes[i].node);
+        }
+    }
+    curr->polling = true;
+}
+
+void SyncPollUnregister(poll_entry_t *entries, poll_node_t *nodes, int n){
+    for(int i = 0; i < n; i++){
+        // Nodes already unlinked by a reclaimed pipe are skipped
+        sync_obj_t *sync;
+        if(nodes[i].node.next != NULL && GetCheckSync(entries[i].id, PIPE, &sync) == SUCCESS){
+            list_remove(&sync->object.pipe->pollers, &nodes[i].node);
+        }
+    }
+    current_process->polling = false;
+}
+
+void SyncPollNotify(list_t *pollers){
+    if(pollers->count == 0) return;
+
+    // Wake every polling process once, it rescans and unregisters itself when it runs
+    list_node_t *head = &pollers->head;
+    for(list_node_t *curr = head->next; curr != head; curr = curr->next){
+        pcb_t *proc = poll_from_node(curr)->proc;
+        if(proc->polling && proc->state == PROCESS_BLOCKED){
+            TracePrintf(1, "Waking polling process %d.\n", proc->pid);
+            proc->polling = false;
+            remove_from_blocked_queue(proc);
+            add_to_ready_queue(proc);
+        }
+    }
+}
+
+// Whether any process is blocked on the object's wait lists, pollers only register and are woken on reclaim
+static bool SyncHasWaiters(sync_obj_t *sync){
+    switch(sync->type){
+        case(PIPE):
+            return sync->object.pipe->readers.count != 0 || sync->object.pipe->writers.count != 0;
+        case(LOCK):
+            return sync->object.lock->waiters.count != 0;
+        case(CVAR):
+            return sync->object.cvar->waiters.count != 0;
+        case(RWLOCK):
+            return sync->object.rwlock->waiters.count != 0;
+        case(SEMAPHORE):
+            return sync->object.sem->waiters.count != 0;
+        case(BARRIER):
+            return sync->object.barrier->waiters.count != 0;
+        default:
+            return false;
+    }
+}
 
 int SyncReclaim(int id){
     TracePrintf(1, "Enter SyncReclaimSync.\n");
@@ -555,16 +1312,30 @@ int SyncReclaim(int id){
 
     // get the object from the table
     sync_obj_t *sync = sync_table[id];
+
+    // A blocked process would be stranded on a freed list, and a timed one would later unlink itself from it
+    if(SyncHasWaiters(sync)){
+        TracePrintf(1, "ERROR, sync object %d still has processes waiting on it.\n", id);
+        return ERROR;
+    }
+
     switch(sync->type){
         case(PIPE):
             pipe_t *pipe = sync->object.pipe;
-            // If these lists aren't empty the processes in the queue WILL break
             clear_list(&pipe->readers);
             clear_list(&pipe->writers);
+            // Pollers are woken and unlinked so they never touch the freed pipe
+            SyncPollNotify(&pipe->pollers);
+            clear_list(&pipe->pollers);
+            free(pipe->buffer);
             free(pipe);
             break;
         case(LOCK):
             lock_t *lock = sync->object.lock;
+            if(lock->owner != NULL) {
+                list_remove(&lock->owner->cold->held_locks, &lock->held_node);
+                SyncRestorePriority(lock->owner);
+            }
             clear_list(&lock->waiters);
             free(lock);
             break;
@@ -573,6 +1344,29 @@ int SyncReclaim(int id){
             clear_list(&cvar->waiters);
             free(cvar);
             break;
+        case(RWLOCK):
+            rwlock_t *rwlock = sync->object.rwlock;
+            clear_list(&rwlock->waiters);
+            // Holders keep nothing that points at the freed rwlock
+            while(!list_is_empty(&rwlock->holds)){
+                SyncRWLockDropHold(rw_hold_from_rwlock_node(peek(&rwlock->holds)));
+            }
+            free(rwlock);
+            break;
+        case(SEMAPHORE):
+            semaphore_t *sem = sync->object.sem;
+            clear_list(&sem->waiters);
+            free(sem);
+            break;
+        case(BARRIER):
+            barrier_t *barrier = sync->object.barrier;
+            clear_list(&barrier->waiters);
+            free(barrier);
+            break;
+        case(SHM):
+            // Attached processes keep their own references on the frames
+            shm_destroy(sync->object.shm);
+            break;
         default:
             // THIS SHOULD NEVER HAPPEN
             TracePrintf(1,"Error, an invalid sync type has occured.\n");
@@ -6,37 +6,88 @@
 #include <stdbool.h>
 
 #include "pcb.h"
+#include "ext_syscalls.h"
+#include "shm.h"
 
 // Magic number sorry bout it
 #define MAX_SYNCS 128
-#define PCB_BLOCKED 30
+#define PCB_BLOCKED (-30)  // Negative so it can't be mistaken for a byte count
+#define PIPE_MAX_CAPACITY (16 * PAGESIZE)
 
 typedef struct pipe {
-    char buffer[PIPE_BUFFER_LEN];
+    char *buffer;            // Ring of capacity bytes, allocated with the pipe
+    int capacity;
     int read_pos;
     int write_pos;
     int bytes_in_buffer;
     struct list readers;
     struct list writers;
+    struct list pollers;     // poll_node_t's of processes blocked in Poll on this pipe
     bool open_for_read;
     bool open_for_write;
+    bool nonblocking;        // Reads and writes return instead of blocking
 } pipe_t;
 
 typedef struct lock {
     bool locked;
     pcb_t *owner;
-    struct list waiters;
+    struct list waiters;        // Ordered by effective priority, highest first
+    list_node_t held_node;      // Node in the owner's held_locks list
 } lock_t;
 
+#define lock_from_held_node(ptr) container_of(ptr, lock_t, held_node)
+
 typedef struct cvar {
     struct list waiters;
 } cvar_t;
 
+typedef struct rwlock {
+    int readers;             // Number of processes holding it for reading
+    pcb_t *writer;           // Process holding it for writing, NULL if none
+    struct list waiters;     // Readers and writers in arrival order
+    struct list holds;       // rw_hold_t's of the processes holding it or queued for it
+} rwlock_t;
+
+// One process's hold on one rwlock, on both of their lists so either side can drop it
+typedef struct rw_hold {
+    rwlock_t *rwlock;
+    pcb_t *proc;
+    int reads;               // Read acquires not released yet, 0 for a writer or while only queued
+    list_node_t proc_node;   // Node in the process's rw_holds list
+    list_node_t rwlock_node; // Node in the rwlock's holds list
+} rw_hold_t;
+
+#define rw_hold_from_proc_node(ptr) container_of(ptr, rw_hold_t, proc_node)
+#define rw_hold_from_rwlock_node(ptr) container_of(ptr, rw_hold_t, rwlock_node)
+
+typedef struct semaphore {
+    int count;               // Tokens currently available
+    struct list waiters;     // Processes waiting for tokens in arrival order
+} semaphore_t;
+
+typedef struct barrier {
+    int parties;             // Number of processes that meet at the barrier
+    int arrived;             // Number that have arrived in the current phase
+    struct list waiters;     // Processes blocked in the current phase
+} barrier_t;
+
+// Registers a polling process on one object's pollers list
+typedef struct poll_node {
+    list_node_t node;
+    pcb_t *proc;
+} poll_node_t;
+
+#define poll_from_node(ptr) container_of(ptr, poll_node_t, node)
+
 // Used to determine what a syncing struct is
 typedef enum {
     PIPE,
     LOCK,
-    CVAR
+    CVAR,
+    RWLOCK,
+    SEMAPHORE,
+    BARRIER,
+    SHM
 } sync_type_t;
 
 // A structure used to store either a pipe, a lock, or a cvar
@@ -47,6 +98,10 @@ typedef struct sync_obj {
         pipe_t *pipe;
         lock_t *lock;
         cvar_t *cvar;
+        rwlock_t *rwlock;
+        semaphore_t *sem;
+        barrier_t *barrier;
+        shm_segment_t *shm;
     } object;
 } sync_obj_t;
 
@@ -58,19 +113,55 @@ int InitSyncObject(sync_type_t type, void *object);
 int GetCheckSync(int id, sync_type_t expected, sync_obj_t **out_sync);
 
 int SyncInitPipe(int *pipe_idp);
+int SyncInitPipeSized(int *pipe_idp, int capacity);
 int SyncReadPipe(int pipe_id, void *buf, int len);
 void SyncDrainWriters(pipe_t *pipe);
 void SyncDrainReaders(pipe_t *pipe);
 int SyncWritePipe(int pipe_id, void *buf, int len);
+int SyncReadPipeTimed(int pipe_id, void *buf, int len, int ticks);
+int SyncPipeSetFlags(int pipe_id, int flags);
+int SyncPipeSplice(int src_id, int dst_id, int n);
 
 int SyncInitLock(int *lock_idp);
 int SyncLockAcquire(int lock_id);
 int SyncLockRelease(int lock_id);
+int SyncLockAcquireTimed(int lock_id, int ticks);
+void SyncLockHandoff(lock_t *lock);
+void SyncBoostOwner(lock_t *lock, int priority);
+bool SyncOwnsLock(int lock_id);
+void SyncRestorePriority(pcb_t *proc);
+void SyncRestoreChain(lock_t *lock);
+void SyncReleaseHeld(pcb_t *proc);
+int SyncSetPriority(int priority);
 
 int SyncInitCvar(int *cvar_idp);
 int SyncCvarSignal(int cvar_id);
 int SyncCvarBroadcast(int cvar_id);
 int SyncCvarWait(int cvar_id, int lock_id);
+int SyncCvarWaitTimed(int cvar_id, int lock_id, int ticks);
+void SyncCvarMorph(pcb_t *waiter);
+
+void SyncCancelWait(pcb_t *waiter);
+void SyncNoteWake(pcb_t *woken);
+void SyncExpireTimeouts(void);
+
+int SyncInitRWLock(int *rwlock_idp);
+int SyncRWLockAcquire(int rwlock_id, bool write);
+int SyncRWLockRelease(int rwlock_id);
+void SyncRWLockGrant(rwlock_t *rwlock);
+void SyncRWLockDropHold(rw_hold_t *hold);
+
+int SyncInitSem(int *sem_idp, int count);
+int SyncSemWait(int sem_id, int n);
+int SyncSemPost(int sem_id, int n);
+
+int SyncInitBarrier(int *barrier_idp, int parties);
+int SyncBarrierWait(int barrier_id);
+
+int SyncPollScan(poll_entry_t *entries, int n);
+void SyncPollRegister(poll_entry_t *entries, poll_node_t *nodes, int n);
+void SyncPollUnregister(poll_entry_t *entries, poll_node_t *nodes, int n);
+void SyncPollNotify(list_t *pollers);
 
 int SyncReclaim(int id);
 int GetNewID(void);
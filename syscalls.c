@@ -8,8 +8,20 @@
 #include "load_program.h"
 #include "context_switch.h"
 #include "pcb.h"
+#include "futex.h"
+#include "shm.h"
+#include "mmap.h"
+#include "swap.h"
+#include "memory.h"
+#include "traps.h"
+#include "sched.h"
 
 syscall_handler_t syscall_handlers[256]; // Array of trap handlers
+syscall_handler_t ext_syscall_handlers[EXT_NUM_CALLS]; // Extended calls multiplexed through Custom0
+unsigned int context_switches = 0;
+
+static void PipeReadCommon(UserContext *uctxt, int pipe_id, void *buf, int len, int ticks);
+static void CvarWaitCommon(UserContext *uctxt, int cvar_id, int lock_id, int ticks);
 
 // Syscall handler table
 void syscalls_init(void){
@@ -36,7 +48,39 @@ void syscalls_init(void){
     syscall_handlers[YALNIX_CVAR_BROADCAST ^ YALNIX_PREFIX] = SysBroadcast;
     syscall_handlers[YALNIX_CVAR_WAIT ^ YALNIX_PREFIX] = SysCvarWait;
     syscall_handlers[YALNIX_RECLAIM ^ YALNIX_PREFIX] = SysReclaim;
+    syscall_handlers[YALNIX_CUSTOM_0 ^ YALNIX_PREFIX] = SysExtended;
     // Add other syscall handlers here
+
+    // Extended calls, see ext_syscalls.h
+    ext_syscall_handlers[EXT_SET_PRIORITY] = SysSetPriority;
+    ext_syscall_handlers[EXT_GET_PRIORITY] = SysGetPriority;
+    ext_syscall_handlers[EXT_RWLOCK_INIT] = SysRWLockInit;
+    ext_syscall_handlers[EXT_RWLOCK_ACQUIRE_READ] = SysRWLockAcquireRead;
+    ext_syscall_handlers[EXT_RWLOCK_ACQUIRE_WRITE] = SysRWLockAcquireWrite;
+    ext_syscall_handlers[EXT_RWLOCK_RELEASE] = SysRWLockRelease;
+    ext_syscall_handlers[EXT_SEM_INIT] = SysSemInit;
+    ext_syscall_handlers[EXT_SEM_WAIT] = SysSemWait;
+    ext_syscall_handlers[EXT_SEM_POST] = SysSemPost;
+    ext_syscall_handlers[EXT_GET_TICKS] = SysGetTicks;
+    ext_syscall_handlers[EXT_FUTEX_WAIT] = SysFutexWait;
+    ext_syscall_handlers[EXT_FUTEX_WAKE] = SysFutexWake;
+    ext_syscall_handlers[EXT_BARRIER_INIT] = SysBarrierInit;
+    ext_syscall_handlers[EXT_BARRIER_WAIT] = SysBarrierWait;
+    ext_syscall_handlers[EXT_LOCK_ACQUIRE_TIMED] = SysLockAcquireTimed;
+    ext_syscall_handlers[EXT_CVAR_WAIT_TIMED] = SysCvarWaitTimed;
+    ext_syscall_handlers[EXT_PIPE_READ_TIMED] = SysPipeReadTimed;
+    ext_syscall_handlers[EXT_POLL] = SysPoll;
+    ext_syscall_handlers[EXT_PIPE_SET_FLAGS] = SysPipeSetFlags;
+    ext_syscall_handlers[EXT_PIPE_INIT_SIZED] = SysPipeInitSized;
+    ext_syscall_handlers[EXT_PIPE_SPLICE] = SysPipeSplice;
+    ext_syscall_handlers[EXT_SHM_CREATE] = SysShmCreate;
+    ext_syscall_handlers[EXT_SHM_ATTACH] = SysShmAttach;
+    ext_syscall_handlers[EXT_MMAP] = SysMmap;
+    ext_syscall_handlers[EXT_MUNMAP] = SysMunmap;
+    ext_syscall_handlers[EXT_PROC_INFO] = SysProcInfo;
+    ext_syscall_handlers[EXT_SWITCH_STATS] = SysSwitchStats;
+    ext_syscall_handlers[EXT_SET_TICKETS] = SysSetTickets;
+    ext_syscall_handlers[EXT_RT_SET] = SysRtSet;
     TracePrintf(1,"Exit syscalls_init.\n");
 }
 
@@ -48,21 +92,23 @@ void SysUnimplemented(UserContext *uctxt){
 
 
 void SysFork(UserContext *uctxt) {
-    if(current_process->should_fork){
+    if(current_process->cold->should_fork){
         pcb_t *parent_pcb = current_process;
         pcb_t *child_pcb = create_pcb(); // add logic for setting up page tables and shit -----------------------------------------
         add_child(parent_pcb, child_pcb);
-        child_pcb->should_fork = false;
+        child_pcb->cold->should_fork = false;
 
         // Copy the user context passed from the trap handler into the new child PCB
-        cpyuc(&child_pcb->user_context, uctxt);
+        cpyuc(&child_pcb->cold->user_context, uctxt);
 
         // Copy the page table content from the parent to the child, allocating new frames for the child
         CopyPageTable(parent_pcb, child_pcb);
 
         // Context switch to the child
-        child_pcb->kernel_stack = InitializeKernelStack();
-        int rc = KernelContextSwitch(KCCopy, child_pcb, NULL);
+        child_pcb->cold->kernel_stack = InitializeKernelStack();
+        // Marks how deep this kernel stack is, so KCCopy only copies what is in use
+        char live;
+        int rc = KernelContextSwitch(KCCopy, child_pcb, &live);
         if (rc == -1) {
             TracePrintf(0, "KernelContextSwitch failed when forking\n");
             Halt();
@@ -72,7 +118,7 @@ void SysFork(UserContext *uctxt) {
 
         uctxt->regs[0] = child_pcb->pid;
     } else {
-        current_process->should_fork = true;
+        current_process->cold->should_fork = true;
         uctxt->regs[0] = 0;
 
     }
@@ -84,20 +130,38 @@ void SysExec(UserContext *uctxt) {
     // Get the filename and args from user space
     char *filename = (char*) uctxt->regs[0];
     char **argvec = (char**) uctxt->regs[1];
+    // LoadProgram reads both before it throws the old address space away
+    if(user_string_ready(filename) == ERROR || user_argv_ready(argvec) == ERROR){
+        TracePrintf(1, "ERROR, the program name or arguments are not readable.\n");
+        uctxt->regs[0] = ERROR;
+        return;
+    }
     // Load the program, then context switch
     int rc = LoadProgram(filename, argvec, current_process);
+    if(rc == KILL) {
+        // The old image was already thrown away and the new one is incomplete, so there is nothing to return to
+        TracePrintf(1, "ERROR, loading failed after the old image was freed, exiting process %d.\n", current_process->pid);
+        uctxt->regs[0] = ERROR;
+        SysExit(uctxt);
+        return;
+    }
     if(rc == ERROR) {
         TracePrintf(1, "ERROR, Loading the program has failed.\n");
-        // Probably need to write code here to make it so a new process is loaded made to run
+        uctxt->regs[0] = ERROR;
+        return;
     }
 
-    cpyuc(uctxt, &current_process->user_context);
+    // LoadProgram only sets the pc and sp, the rest of the trap frame can stay as it is
+    uctxt->pc = current_process->cold->user_context.pc;
+    uctxt->sp = current_process->cold->user_context.sp;
 
     TracePrintf(1, "Exit SysExec.\n");
 }
 
 void SysExit(UserContext *uctxt) {
     terminate_process(current_process, (int) uctxt->regs[0]);
+    // The PCB may already be freed, so schedule must not save into it
+    current_process = NULL;
     // Schedule the next process
     schedule(uctxt);
 
@@ -107,14 +171,19 @@ void SysWait(UserContext *uctxt) {
     TracePrintf(1, "Enter SysWait.\n");
     // Check to see if the process has any children
         // If not return an error
-    if(list_is_empty(&current_process->children)){
+    if(list_is_empty(&current_process->cold->children)){
         uctxt->regs[0] = ERROR;
         TracePrintf(1, "ERROR, the process has no children to wait for.\n");
         return;
     }
 
-    // Get the status pointer
+    // Get the status pointer, and make sure the status can be stored before a child is reaped
     int *status_ptr = (int *) uctxt->regs[0];
+    if(status_ptr != NULL && user_buffer_ready(status_ptr, sizeof(int), true) == ERROR){
+        uctxt->regs[0] = ERROR;
+        TracePrintf(1, "ERROR, the status pointer %p is not writable.\n", status_ptr);
+        return;
+    }
     // Check to see if the process has any children currently waiting, if there are
         // grab the child's PID and exit status
     pcb_t *z_child = find_zombie_child(current_process);
@@ -127,21 +196,24 @@ void SysWait(UserContext *uctxt) {
     if (z_child == NULL){
         TracePrintf(1, "Parent %d is waiting on children and is blocked.\n", current_process->pid);
         current_process->state = PROCESS_DEFAULT;
-        int *kstatus_ptr = malloc(sizeof(int));
-        uctxt->regs[0] = (int) kstatus_ptr;
-        current_process->waiting_for_children = 1;
+        current_process->cold->waiting_for_children = 1;
         add_to_blocked_queue(current_process);
-        pcb_t *next = schedule(uctxt);
-        memcpy(status_ptr, kstatus_ptr, sizeof(int));
-        free(kstatus_ptr);
+        // The exiting child sets the saved regs[0] to its pid and leaves its status in the PCB
+        schedule(uctxt);
+        current_process->cold->waiting_for_children = 0;
+        // Other processes ran in the meantime, so the status page may have been paged out again
+        if(status_ptr != NULL && user_buffer_ready(status_ptr, sizeof(int), true) == SUCCESS){
+            *status_ptr = current_process->cold->child_status;
+        }
 
     }
     // Remove the child from the list of children
     else {
         remove_from_zombie_queue(z_child);
-        if(status_ptr != NULL) *status_ptr = z_child->exit_code;
+        // Checked above, and nothing has run since
+        if(status_ptr != NULL) *status_ptr = z_child->cold->exit_code;
         uctxt->regs[0] = z_child->pid;
-        free(z_child); // Need to go back and make sure terminate_process clears all other parts of memory as well. Maybe need to write a special function
+        free_pcb(z_child); // Need to go back and make sure terminate_process clears all other parts of memory as well. Maybe need to write a special function
     }
     // else return the the child's PID
 
@@ -163,11 +235,13 @@ void SysBrk(UserContext *uctxt){
     TracePrintf(1, "ENTER SysBrk. addr is %08x.\n", (unsigned int) addr);
     pcb_t* curr = current_process;
     unsigned int nbrk = (UP_TO_PAGE(addr)>>PAGESHIFT) - MAX_PT_LEN;
-    unsigned int cbrk = (unsigned int) curr->brk>>PAGESHIFT;
-    // Check to see if the address is a valid spot for the break (not above the stack or below the base of the heap)
+    unsigned int cbrk = (unsigned int) curr->cold->brk>>PAGESHIFT;
+    unsigned int base = (unsigned int) curr->cold->heap_base>>PAGESHIFT;
+    unsigned int stack = (DOWN_TO_PAGE(curr->cold->user_context.sp) - VMEM_1_BASE)>>PAGESHIFT;
+    // Check to see if the address is a valid spot for the break (below the red zone under the stack, under any mapping, and not below the base of the heap)
         // If not return an error
-    if  (nbrk >= DOWN_TO_PAGE(current_process->user_context.sp)>>PAGESHIFT){
-        TracePrintf(1, "ERROR, new brk is above current stack pointer.\n");
+    if  (addr < VMEM_1_BASE || nbrk < base || nbrk >= stack - 1 || nbrk > (unsigned int) lowest_mapping_page(curr)){
+        TracePrintf(1, "ERROR, new brk %08x is outside of the heap's room.\n", addr);
         uctxt->regs[0] = ERROR;
         return;
     }
@@ -177,39 +251,29 @@ void SysBrk(UserContext *uctxt){
         uctxt->regs[0] = 0;
         return;
     }
-    // If brk is above the old break, allocate new pages
+    // If brk is above the old break only the limit moves, memory_handler gives each page a zeroed frame on first touch
     if (nbrk > cbrk){
-        TracePrintf(1, "brk is being moved from %08x up to %08x.\n", curr->brk, UP_TO_PAGE(addr));
-        for(unsigned int i = cbrk; i < nbrk; i++){
-            if(current_process->region1_pt[i].valid == 0){
-                int nf = allocate_frame();
-                if(nf == ERROR){
-                    TracePrintf(1, "ERROR, no new frames to allocate for SysBrk.\n");
-                    uctxt->regs[0] = ERROR;
-                    return;
-                }
-                current_process->region1_pt[i].valid = 1;
-                current_process->region1_pt[i].prot = PROT_READ | PROT_WRITE;
-                current_process->region1_pt[i].pfn = nf;
-            }
-        }
-        TracePrintf(1, "brk has been moved from %08x up to %08x.\n", curr->brk, UP_TO_PAGE(addr));
+        TracePrintf(1, "brk has been moved from %08x up to %08x.\n", curr->cold->brk, UP_TO_PAGE(addr));
     }
     // if brk is below the old break
     else{
-        TracePrintf(1, "brk has is being moved from %08x down to %08x.\n", curr->brk, UP_TO_PAGE(addr));
-        for(unsigned int i = cbrk - 1; i < nbrk; i--){
+        TracePrintf(1, "brk has is being moved from %08x down to %08x.\n", curr->cold->brk, UP_TO_PAGE(addr));
+        for(unsigned int i = nbrk; i < cbrk; i++){
             if(current_process->region1_pt[i].valid == 1){
                 int fn = current_process->region1_pt[i].pfn;
                 free_frame(fn);
-                WriteRegister(REG_TLB_FLUSH, i << PAGESHIFT);
+                WriteRegister(REG_TLB_FLUSH, VMEM_1_BASE + (i << PAGESHIFT));
                 current_process->region1_pt[i].valid = 0;
                 current_process->region1_pt[i].prot = 0;
                 current_process->region1_pt[i].pfn = 0;
+                current_process->cold->page_meta[i].cow = false;
+            } else {
+                swap_discard(current_process, i);
             }
         }
-        TracePrintf(1, "brk has been moved from %08x down to %08x.\n", curr->brk, UP_TO_PAGE(addr));
+        TracePrintf(1, "brk has been moved from %08x down to %08x.\n", curr->cold->brk, UP_TO_PAGE(addr));
     }
+    curr->cold->brk = (void *)(nbrk << PAGESHIFT);
     uctxt->regs[0] = 0;
     TracePrintf(1, "EXIT SysBrk.\n");
 }
@@ -281,6 +345,10 @@ void SysTtyWrite(UserContext *uctxt){
 void SysPipeInit(UserContext *uctxt){
     // get the pipe id from the UserContext
     int *pipe_idp = (int *)uctxt->regs[0];
+    if(user_buffer_ready(pipe_idp, sizeof(int), true) == ERROR){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
     // Allocate the pipe using InitPipe fomr sync
     uctxt->regs[0] = SyncInitPipe(pipe_idp);
 
@@ -291,25 +359,38 @@ void SysPipeRead(UserContext *uctxt){
     int pipe_id = uctxt->regs[0];
     void *buf = (void *)uctxt->regs[1]; // CREATE A SECOND BUFFER IN KERNEL TO PASS
     int len = uctxt->regs[2]; 
-    
+    PipeReadCommon(uctxt, pipe_id, buf, len, 0);
+
+}
+
+static void PipeReadCommon(UserContext *uctxt, int pipe_id, void *buf, int len, int ticks){
     //kbuf is used in case the process gets blocked, it is stored in the kernel so that it can be written to even if the proc isn't running
     void *kbuf = malloc(len);
+    if(kbuf == NULL){
+        TracePrintf(1, "ERROR, could not allocate a kernel buffer for the pipe read.\n");
+        uctxt->regs[0] = ERROR;
+        return;
+    }
     
     // pass these values, along with current pcb, to ReadPipe from sync
     // if it returns, return the return value of ReadPipe
-    int rc = SyncReadPipe(pipe_id, kbuf, len);
-    if(rc == PROCESS_BLOCKED){
+    int rc = ticks > 0 ? SyncReadPipeTimed(pipe_id, kbuf, len, ticks) : SyncReadPipe(pipe_id, kbuf, len);
+    if(rc == PCB_BLOCKED){
         schedule(uctxt);
+        // The writer that filled kbuf left the byte count in our saved regs[0]
+        rc = current_process->timed_out ? WAIT_TIMEOUT : (int)uctxt->regs[0];
+        current_process->timed_out = false;
     
     } else if (rc == ERROR){
         TracePrintf(1, "Something went wrong with SyncReadPipe.\n");
-        return;
 
     }
     
-    // Copy what is written into the kernel buffer into the user buffer, this is only reached after being rescheduled. 
-    memcpy(buf, kbuf, len);
+    // Copy what was read into the kernel buffer into the user buffer
+    if(rc > 0 && user_buffer_ready(buf, rc, true) == ERROR) rc = ERROR;
+    if(rc > 0) memcpy(buf, kbuf, rc);
     free(kbuf);
+    uctxt->regs[0] = rc;
 
 }
 
@@ -319,18 +400,23 @@ void SysPipeWrite(UserContext *uctxt){
     void *buf = (void *)uctxt->regs[1]; // CREATE A SECOND BUFFER IN KERNEL TO PASS
     int len = uctxt->regs[2]; 
    
+    if(user_buffer_ready(buf, len, false) == ERROR){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
     //kbuf is used to store the contents of buf in kernel so that it can still work if the process is not scheudled
     void *kbuf = malloc(len);
     memcpy(kbuf, buf, len);
     
     // pass these values to WritePipe from sync
     int rc = SyncWritePipe(pipe_id, kbuf, len);
-    if(rc == PROCESS_BLOCKED){
+    if(rc == PCB_BLOCKED){
+        // The reader that drained the rest of kbuf left the byte count in our saved regs[0]
         schedule(uctxt);
 
-    } else if (rc == ERROR){
-        TracePrintf(1, "Something went wrong with SyncWritePipe.\n");
-        return;
+    } else {
+        if (rc == ERROR) TracePrintf(1, "Something went wrong with SyncWritePipe.\n");
+        uctxt->regs[0] = rc;
 
     }
 
@@ -342,6 +428,10 @@ void SysPipeWrite(UserContext *uctxt){
 void SysLockInit(UserContext *uctxt){
     // Get the int *lock_id from the UserContext
     int *lock_idp = (int *)uctxt->regs[0];
+    if(user_buffer_ready(lock_idp, sizeof(int), true) == ERROR){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
     // pass the values to InitLock from sync.c
     uctxt->regs[0] = SyncInitLock(lock_idp);
 
@@ -352,8 +442,10 @@ void SysLockAcquire(UserContext *uctxt){
     int lock_id = uctxt->regs[0];
     // pass the values to Acquire from sync.c
     int rc = SyncLockAcquire(lock_id);
-    if (rc == PROCESS_BLOCKED){
+    if (rc == PCB_BLOCKED){
+        // The releaser hands the lock over before this process is woken
         schedule(uctxt);
+        uctxt->regs[0] = SUCCESS;
         
     } else {
         uctxt->regs[0] = rc;
@@ -372,6 +464,10 @@ void SysLockRelease(UserContext *uctxt){
 void SysCvarInit(UserContext *uctxt){
     // Get the int *cvar_id from the UserContext
     int *lock_idp = (int *)uctxt->regs[0];
+    if(user_buffer_ready(lock_idp, sizeof(int), true) == ERROR){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
     // pass the values to InitCvar from sync.c
     uctxt->regs[0] = SyncInitCvar(lock_idp);
 
@@ -396,10 +492,14 @@ void SysBroadcast(UserContext *uctxt){
 void SysCvarWait(UserContext *uctxt){
     // Get the int cvar_id and int lock_id from the UserContext
     int cvar_id = uctxt->regs[0];
-    int lock_id = uctxt->regs[0];
+    int lock_id = uctxt->regs[1];
+    CvarWaitCommon(uctxt, cvar_id, lock_id, 0);
 
+}
+
+static void CvarWaitCommon(UserContext *uctxt, int cvar_id, int lock_id, int ticks){
     // pass the values to CvarWait from sync.c
-    int rc = SyncCvarWait(cvar_id, lock_id);
+    int rc = ticks > 0 ? SyncCvarWaitTimed(cvar_id, lock_id, ticks) : SyncCvarWait(cvar_id, lock_id);
     if (rc == ERROR){
         uctxt->regs[0] = ERROR;
         return;
@@ -407,9 +507,15 @@ void SysCvarWait(UserContext *uctxt){
    
     // Otherwise the process is now blocked
     schedule(uctxt);
-    // Attempt to reacquire the lock afterwards
-    SyncLockAcquire(lock_id);
-    uctxt->regs[0] = SUCCESS;
+    rc = current_process->timed_out ? WAIT_TIMEOUT : SUCCESS;
+    current_process->timed_out = false;
+
+    // A signal moves the waiter onto the lock, so it normally wakes up owning it already,
+    // otherwise (timed out, or the lock was reclaimed) reacquire it, blocking again if it is held
+    if (!SyncOwnsLock(lock_id) && SyncLockAcquire(lock_id) == PCB_BLOCKED){
+        schedule(uctxt);
+    }
+    uctxt->regs[0] = rc;
 
 }
 
@@ -421,27 +527,478 @@ void SysReclaim(UserContext *uctxt){
 
 }
 
+void SysExtended(UserContext *uctxt){
+    // The operation is the first argument, the rest are the actual arguments of the call
+    int op = uctxt->regs[0];
+    TracePrintf(1, "Extended syscall %d is being called.\n", op);
+    if(op < 0 || op >= EXT_NUM_CALLS || ext_syscall_handlers[op] == NULL){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+
+    // Shift the arguments down so the handler reads them from regs[0] onward like any other syscall
+    for(int i = 0; i < GREGS - 1; i++){
+        uctxt->regs[i] = uctxt->regs[i + 1];
+    }
+    ext_syscall_handlers[op](uctxt);
+}
+
+void SysSetPriority(UserContext *uctxt){
+    // Get the new base priority from the UserContext
+    int priority = uctxt->regs[0];
+    // pass the value to SetPriority from sync.c, since inherited priority comes from held locks
+    uctxt->regs[0] = SyncSetPriority(priority);
+
+}
+
+void SysGetPriority(UserContext *uctxt){
+    // Return the effective priority, including anything inherited through locks
+    uctxt->regs[0] = current_process->priority;
+
+}
+
+void SysRWLockInit(UserContext *uctxt){
+    // Get the int *rwlock_id from the UserContext
+    int *rwlock_idp = (int *)uctxt->regs[0];
+    if(user_buffer_ready(rwlock_idp, sizeof(int), true) == ERROR){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+    // pass the values to InitRWLock from sync.c
+    uctxt->regs[0] = SyncInitRWLock(rwlock_idp);
+
+}
+
+void SysRWLockAcquireRead(UserContext *uctxt){
+    // Get the int rwlock_id from the UserContext
+    int rwlock_id = uctxt->regs[0];
+    // pass the values to RWLockAcquire from sync.c
+    int rc = SyncRWLockAcquire(rwlock_id, false);
+    if (rc == PCB_BLOCKED){
+        // The releaser grants the read hold before this process is woken
+        schedule(uctxt);
+        uctxt->regs[0] = SUCCESS;
+
+    } else {
+        uctxt->regs[0] = rc;
+
+    }
+}
+
+void SysRWLockAcquireWrite(UserContext *uctxt){
+    // Get the int rwlock_id from the UserContext
+    int rwlock_id = uctxt->regs[0];
+    // pass the values to RWLockAcquire from sync.c
+    int rc = SyncRWLockAcquire(rwlock_id, true);
+    if (rc == PCB_BLOCKED){
+        // The releaser grants the write hold before this process is woken
+        schedule(uctxt);
+        uctxt->regs[0] = SUCCESS;
+
+    } else {
+        uctxt->regs[0] = rc;
+
+    }
+}
+
+void SysRWLockRelease(UserContext *uctxt){
+    // Get the int rwlock_id from the UserContext
+    int rwlock_id = uctxt->regs[0];
+    // pass the values to RWLockRelease from sync.c
+    uctxt->regs[0] = SyncRWLockRelease(rwlock_id);
+
+}
+
+void SysSemInit(UserContext *uctxt){
+    // Get the int *sem_id and initial count from the UserContext
+    int *sem_idp = (int *)uctxt->regs[0];
+    int count = uctxt->regs[1];
+    if(user_buffer_ready(sem_idp, sizeof(int), true) == ERROR){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+    // pass the values to InitSem from sync.c
+    uctxt->regs[0] = SyncInitSem(sem_idp, count);
+
+}
+
+void SysSemWait(UserContext *uctxt){
+    // Get the int sem_id and the number of tokens from the UserContext
+    int sem_id = uctxt->regs[0];
+    int n = uctxt->regs[1];
+    // pass the values to SemWait from sync.c
+    int rc = SyncSemWait(sem_id, n);
+    if (rc == PCB_BLOCKED){
+        // The poster takes the tokens on our behalf before this process is woken
+        schedule(uctxt);
+        uctxt->regs[0] = SUCCESS;
+
+    } else {
+        uctxt->regs[0] = rc;
+
+    }
+}
+
+void SysSemPost(UserContext *uctxt){
+    // Get the int sem_id and the number of tokens from the UserContext
+    int sem_id = uctxt->regs[0];
+    int n = uctxt->regs[1];
+    // pass the values to SemPost from sync.c
+    uctxt->regs[0] = SyncSemPost(sem_id, n);
+
+}
+
+void SysGetTicks(UserContext *uctxt){
+    // Clock ticks since boot, used by user programs to time themselves
+    uctxt->regs[0] = clock_ticks;
+
+}
+
+void SysFutexWait(UserContext *uctxt){
+    // Get the address and the expected value from the UserContext
+    int *addr = (int *)uctxt->regs[0];
+    int val = uctxt->regs[1];
+    // pass the values to futex_wait from futex.c
+    int rc = futex_wait(addr, val);
+    if (rc == PCB_BLOCKED){
+        // A futex_wake put this process back on the ready queue
+        schedule(uctxt);
+        uctxt->regs[0] = SUCCESS;
+
+    } else {
+        uctxt->regs[0] = rc;
+
+    }
+}
+
+void SysFutexWake(UserContext *uctxt){
+    // Get the address and the number of waiters to wake from the UserContext
+    int *addr = (int *)uctxt->regs[0];
+    int n = uctxt->regs[1];
+    // pass the values to futex_wake from futex.c
+    uctxt->regs[0] = futex_wake(addr, n);
+
+}
+
+void SysBarrierInit(UserContext *uctxt){
+    // Get the int *barrier_id and the number of parties from the UserContext
+    int *barrier_idp = (int *)uctxt->regs[0];
+    int parties = uctxt->regs[1];
+    if(user_buffer_ready(barrier_idp, sizeof(int), true) == ERROR){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+    // pass the values to InitBarrier from sync.c
+    uctxt->regs[0] = SyncInitBarrier(barrier_idp, parties);
+
+}
+
+void SysBarrierWait(UserContext *uctxt){
+    // Get the int barrier_id from the UserContext
+    int barrier_id = uctxt->regs[0];
+    // pass the values to BarrierWait from sync.c
+    int rc = SyncBarrierWait(barrier_id);
+    if (rc == PCB_BLOCKED){
+        // The last arriver moved this process back onto the ready queue
+        schedule(uctxt);
+        uctxt->regs[0] = SUCCESS;
+
+    } else {
+        uctxt->regs[0] = rc;
+
+    }
+}
+
+void SysLockAcquireTimed(UserContext *uctxt){
+    // Get the int lock_id and the timeout from the UserContext
+    int lock_id = uctxt->regs[0];
+    int ticks = uctxt->regs[1];
+    // pass the values to LockAcquireTimed from sync.c
+    int rc = SyncLockAcquireTimed(lock_id, ticks);
+    if (rc == PCB_BLOCKED){
+        // Either the releaser handed the lock over or the clock gave up on it
+        schedule(uctxt);
+        rc = current_process->timed_out ? WAIT_TIMEOUT : SUCCESS;
+        current_process->timed_out = false;
+
+    }
+    uctxt->regs[0] = rc;
+}
+
+void SysCvarWaitTimed(UserContext *uctxt){
+    // Get the int cvar_id, int lock_id and the timeout from the UserContext
+    int cvar_id = uctxt->regs[0];
+    int lock_id = uctxt->regs[1];
+    int ticks = uctxt->regs[2];
+    if (ticks <= 0){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+    CvarWaitCommon(uctxt, cvar_id, lock_id, ticks);
+
+}
+
+void SysPipeReadTimed(UserContext *uctxt){
+    // Get the pipe id, the buffer description and the timeout from the UserContext
+    int pipe_id = uctxt->regs[0];
+    ext_buf_t *b = (ext_buf_t *)uctxt->regs[1];
+    int ticks = uctxt->regs[2];
+    if (user_buffer_ready(b, sizeof(ext_buf_t), false) == ERROR || ticks <= 0){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+    PipeReadCommon(uctxt, pipe_id, b->buf, b->len, ticks);
+
+}
+
+void SysPoll(UserContext *uctxt){
+    TracePrintf(1, "Enter SysPoll.\n");
+    // Get the entries, the number of entries and the timeout from the UserContext
+    poll_entry_t *entries = (poll_entry_t *)uctxt->regs[0];
+    int n = uctxt->regs[1];
+    int ticks = uctxt->regs[2];
+    if(n <= 0 || n > MAX_SYNCS || user_buffer_ready(entries, n * sizeof(poll_entry_t), true) == ERROR){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+
+    // Work on a kernel copy, the user buffer is only reachable while this process is running anyway
+    poll_entry_t *kentries = malloc(n * sizeof(poll_entry_t));
+    poll_node_t *nodes = malloc(n * sizeof(poll_node_t));
+    if(kentries == NULL || nodes == NULL){
+        free(kentries);
+        free(nodes);
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+    memcpy(kentries, entries, n * sizeof(poll_entry_t));
+
+    unsigned int deadline = clock_ticks + ticks;
+    int ready = SyncPollScan(kentries, n);
+    while(ready == 0 && ticks != 0){
+        // Block until any watched pipe changes or the timeout runs out
+        SyncPollRegister(kentries, nodes, n);
+        current_process->state = PROCESS_DEFAULT;
+        add_to_blocked_queue(current_process);
+        if(ticks > 0){
+            int remaining = (int)(deadline - clock_ticks);
+            add_to_timeout_queue(current_process, remaining > 0 ? remaining : 1, blocked_queue);
+        }
+        schedule(uctxt);
+        SyncPollUnregister(kentries, nodes, n);
+
+        ready = SyncPollScan(kentries, n);
+        if(current_process->timed_out){
+            current_process->timed_out = false;
+            break;
+        }
+    }
+
+    // Hand readiness back without copying any pipe data
+    // The entries may have been paged out while this process waited
+    if(user_buffer_ready(entries, n * sizeof(poll_entry_t), true) == 0) memcpy(entries, kentries, n * sizeof(poll_entry_t));
+    free(kentries);
+    free(nodes);
+    uctxt->regs[0] = ready;
+    TracePrintf(1, "Exit SysPoll with %d ready.\n", ready);
+}
+
+void SysPipeSetFlags(UserContext *uctxt){
+    // Get the pipe id and the new flags from the UserContext
+    int pipe_id = uctxt->regs[0];
+    int flags = uctxt->regs[1];
+    // pass the values to PipeSetFlags from sync.c
+    uctxt->regs[0] = SyncPipeSetFlags(pipe_id, flags);
+
+}
+
+void SysPipeInitSized(UserContext *uctxt){
+    // get the pipe id pointer and the ring capacity from the UserContext
+    int *pipe_idp = (int *)uctxt->regs[0];
+    int capacity = uctxt->regs[1];
+    if(user_buffer_ready(pipe_idp, sizeof(int), true) == ERROR){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+    // Allocate the pipe using InitPipeSized from sync
+    uctxt->regs[0] = SyncInitPipeSized(pipe_idp, capacity);
+
+}
+
+void SysPipeSplice(UserContext *uctxt){
+    // Get the source and destination pipe ids and the byte count from the UserContext
+    int src_id = uctxt->regs[0];
+    int dst_id = uctxt->regs[1];
+    int n = uctxt->regs[2];
+    // Move the bytes kernel side using PipeSplice from sync.c
+    uctxt->regs[0] = SyncPipeSplice(src_id, dst_id, n);
+
+}
+
+void SysShmCreate(UserContext *uctxt){
+    // Get the segment id pointer and the size from the UserContext
+    int *shm_idp = (int *)uctxt->regs[0];
+    int size = uctxt->regs[1];
+    if(user_buffer_ready(shm_idp, sizeof(int), true) == ERROR){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+    // Allocate the segment and its frames with shm_create
+    uctxt->regs[0] = shm_create(shm_idp, size);
+
+}
+
+void SysShmAttach(UserContext *uctxt){
+    // Get the segment id and where to return the mapped address from the UserContext
+    int shm_id = uctxt->regs[0];
+    void **addrp = (void **)uctxt->regs[1];
+    if(user_buffer_ready(addrp, sizeof(void *), true) == ERROR){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+    // Map the segment into the current process with shm_attach
+    uctxt->regs[0] = shm_attach(shm_id, addrp);
+
+}
+
+void SysMmap(UserContext *uctxt){
+    // Get the mapping arguments from the UserContext
+    mmap_args_t *args = (mmap_args_t *)uctxt->regs[0];
+    if(user_buffer_ready(args, sizeof(mmap_args_t), true) == ERROR || user_string_ready(args->path) == ERROR){
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+    // Reserve the pages with mmap_create, they are read in by memory_handler
+    uctxt->regs[0] = mmap_create(args);
+
+}
+
+void SysMunmap(UserContext *uctxt){
+    // Get the mapping's address from the UserContext
+    void *addr = (void *)uctxt->regs[0];
+    // Write back and unmap it with mmap_remove
+    uctxt->regs[0] = mmap_remove(addr);
+
+}
+
+void SysProcInfo(UserContext *uctxt){
+    TracePrintf(1, "ENTER SysProcInfo.\n");
+    // Get the pid and the info buffer from the UserContext
+    int pid = uctxt->regs[0];
+    proc_info_t *info = (proc_info_t *)uctxt->regs[1];
+    // Only the caller and its children can be inspected
+    pcb_t *proc = (pid == 0 || pid == current_process->pid) ? current_process : find_child(current_process, pid);
+    if(proc == NULL || proc->state == PROCESS_ZOMBIE || user_buffer_ready(info, sizeof(proc_info_t), true) == ERROR){
+        TracePrintf(1, "ERROR, pid %d is not the caller or one of its live children.\n", pid);
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+
+    info->pid = proc->pid;
+    info->priority = proc->priority;
+    info->resident_pages = 0;
+    info->swapped_pages = 0;
+    for(int i = 0; i < MAX_PT_LEN; i++){
+        if(proc->region1_pt[i].valid || proc->cold->page_meta[i].revoked) info->resident_pages++;
+        else if(proc->cold->page_meta[i].swap_slot != NO_SWAP_SLOT) info->swapped_pages++;
+    }
+    info->minor_faults = proc->cold->minor_faults;
+    info->major_faults = proc->cold->major_faults;
+    info->cow_breaks = proc->cold->cow_breaks;
+    info->working_set = proc->cold->working_set;
+    uctxt->regs[0] = SUCCESS;
+    TracePrintf(1, "EXIT SysProcInfo.\n");
+}
+
+void SysSwitchStats(UserContext *uctxt){
+    TracePrintf(1, "ENTER SysSwitchStats.\n");
+    switch_stats_t *stats = (switch_stats_t *) uctxt->regs[0];
+    if(stats == NULL || user_buffer_ready(stats, sizeof(switch_stats_t), true) == ERROR){
+        TracePrintf(1, "ERROR, the stats pointer is not writable.\n");
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+    stats->switches = context_switches;
+    stats->uctxt_bytes = uctxt_copy_bytes;
+    uctxt->regs[0] = SUCCESS;
+    TracePrintf(1, "EXIT SysSwitchStats.\n");
+}
+
+
+void SysSetTickets(UserContext *uctxt){
+    TracePrintf(1, "ENTER SysSetTickets.\n");
+    int pid = uctxt->regs[0];
+    int tickets = uctxt->regs[1];
+    // A process can set its own share or a child's, e.g. a service it started
+    pcb_t *proc = (pid == 0 || pid == current_process->pid) ? current_process : find_child(current_process, pid);
+    if(proc == NULL || proc->state == PROCESS_ZOMBIE){
+        TracePrintf(1, "ERROR, pid %d is not the caller or one of its live children.\n", pid);
+        uctxt->regs[0] = ERROR;
+        return;
+    }
+    uctxt->regs[0] = sched_set_tickets(proc, tickets);
+    TracePrintf(1, "EXIT SysSetTickets.\n");
+}
+
+void SysRtSet(UserContext *uctxt){
+    TracePrintf(1, "ENTER SysRtSet.\n");
+    int period = uctxt->regs[0];
+    int budget = uctxt->regs[1];
+    uctxt->regs[0] = rt_set(current_process, period, budget);
+    TracePrintf(1, "EXIT SysRtSet.\n");
+}
+
 pcb_t *schedule(UserContext *uctxt){
     TracePrintf(1, "Enter schedule.\n");
     pcb_t *curr = current_process;
-    TracePrintf(1, "Descheduling process %d, sp %p, pc %p, saved into %p.\n", curr->pid, uctxt->sp, uctxt->pc, curr->user_context);
-    pcb_t *next;
-    if(ready_queue->count == 0){
-        next = idle_process;
-    } else next = pcb_from_queue_node(pop(ready_queue));
-    cpyuc(&current_process->user_context, uctxt);
-
-    next->run_time = 0;
+    pcb_t *next = NULL;
+    int donated = 0;
+
+    // Directed handoff: a waker that blocks runs the peer it just woke on the rest of its own slice,
+    // instead of making it wait behind the whole ready queue. A preempted waker has no slice left to
+    // donate, so the peer keeps its place in the queue like everyone else.
+    // The peer cannot have run since it was woken, because that would have meant scheduling curr out.
+    if(curr != NULL && curr->handoff != NULL){
+        pcb_t *peer = curr->handoff;
+        curr->handoff = NULL;
+        if(curr->state != PROCESS_READY && peer->state == PROCESS_READY && sched_can_handoff(peer)){
+            remove_from_ready_queue(peer);
+            next = peer;
+            donated = curr->run_time;
+            TracePrintf(1, "Handing off from process %d to process %d.\n", curr->pid, peer->pid);
+        }
+    }
+    if(next == NULL) next = sched_pick_next();
+    if(next == NULL) next = idle_process;
+
+    next->run_time = donated;
+    if(next == curr){
+        // Nothing else can run, keep going on the trap frame as it is
+        curr->state = PROCESS_RUNNING;
+        TracePrintf(1, "Exit schedule, process %d keeps running.\n", curr->pid);
+        return next;
+    }
+
+    // A process that is not going back on the ready queue has blocked
+    if(curr != NULL && curr != idle_process && !curr->rt && curr->state != PROCESS_READY) sched->on_block(curr);
+
+    // Save the outgoing registers once, an exited process has nothing worth saving
+    if(curr != NULL){
+        TracePrintf(1, "Descheduling process %d, sp %p, pc %p.\n", curr->pid, uctxt->sp, uctxt->pc);
+        cpyuc(&curr->cold->user_context, uctxt);
+    }
+    context_switches++;
+
     int kc = KernelContextSwitch(KCSwitch, (void *) curr, (void *) next);
     if(kc == ERROR){
         TracePrintf(1, "There was an issue during switching.\n");
         return NULL;
     }
     //current_process should already be put into a different queue at this point
-    cpyuc(uctxt, &current_process->user_context);    
+    cpyuc(uctxt, &current_process->cold->user_context);    
     WriteRegister(REG_PTBR1, (unsigned int)current_process->region1_pt);
     WriteRegister(REG_TLB_FLUSH, TLB_FLUSH_1);
-    TracePrintf(1, "Process %d scheduled, sp %p, pc %p, copied from %p, into %p.\n", current_process->pid, uctxt->sp, uctxt->pc, current_process->user_context, uctxt);
+    TracePrintf(1, "Process %d scheduled, sp %p, pc %p.\n", current_process->pid, uctxt->sp, uctxt->pc);
     TracePrintf(1, "Exit schedule.\n");
     return next;
 }
@@ -3,11 +3,14 @@
 #include "pcb.h"
 #include "sync.h"
 #include "memory.h"
+#include "ext_syscalls.h"
 
 // Declare the array of syscall handler function pointers
 typedef void (*syscall_handler_t)(UserContext *uctxt);
 
 extern syscall_handler_t syscall_handlers[256]; // Array of trap handlers
+extern syscall_handler_t ext_syscall_handlers[EXT_NUM_CALLS]; // Extended calls multiplexed through Custom0
+extern unsigned int context_switches;  // Switches made by schedule, reported by SwitchStats
 void syscalls_init(void);
 
 void SysUnimplemented(UserContext *uctxt);
@@ -31,4 +34,44 @@ void SysSignal(UserContext *uctxt);
 void SysBroadcast(UserContext *uctxt);
 void SysCvarWait(UserContext *uctxt);
 void SysReclaim(UserContext *uctxt);
+void SysExtended(UserContext *uctxt);
+void SysSetPriority(UserContext *uctxt);
+void SysGetPriority(UserContext *uctxt);
+void SysRWLockInit(UserContext *uctxt);
+void SysRWLockAcquireRead(UserContext *uctxt);
+void SysRWLockAcquireWrite(UserContext *uctxt);
+void SysRWLockRelease(UserContext *uctxt);
+void SysSemInit(UserContext *uctxt);
+void SysSemWait(UserContext *uctxt);
+void SysSemPost(UserContext *uctxt);
+void SysGetTicks(UserContext *uctxt);
+void SysFutexWait(UserContext *uctxt);
+void SysFutexWake(UserContext *uctxt);
+void SysBarrierInit(UserContext *uctxt);
+void SysBarrierWait(UserContext *uctxt);
+void SysLockAcquireTimed(UserContext *uctxt);
+void SysCvarWaitTimed(UserContext *uctxt);
+void SysPipeReadTimed(UserContext *uctxt);
+void SysPoll(UserContext *uctxt);
+void SysPipeSetFlags(UserContext *uctxt);
+void SysPipeInitSized(UserContext *uctxt);
+void SysPipeSplice(UserContext *uctxt);
+void SysShmCreate(UserContext *uctxt);
+void SysShmAttach(UserContext *uctxt);
+void SysMmap(UserContext *uctxt);
+void SysMunmap(UserContext *uctxt);
+void SysProcInfo(UserContext *uctxt);
+void SysSwitchStats(UserContext *uctxt);
+void SysSetTickets(UserContext *uctxt);
+void SysRtSet(UserContext *uctxt);
+
+/**
+ * Switches from current_process to the next ready process (or idle).
+ *
+ * A running process's registers live only in the trap frame, its PCB's
+ * user_context is written once here when it switches out and read back once
+ * when it switches in. Wakers may set the saved regs[0] of a blocked process
+ * to hand it a return value. If current_process is NULL (the caller has
+ * exited) nothing is saved.
+ */
 pcb_t *schedule(UserContext *uctxt);
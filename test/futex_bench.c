@@ -0,0 +1,48 @@
+#include <yuser.h>
+#include "ulock.h"
+
+#define ITERATIONS 100000
+
+int main(void) {
+    TracePrintf(0, "Hello, futex_bench!\n");
+
+    // Kernel lock: every Acquire and Release is a trap
+    int lock_id;
+    if (LockInit(&lock_id) == ERROR) {
+        TracePrintf(0, "ERROR: LockInit failed\n");
+        Exit(1);
+    }
+    int start = GetTicks();
+    for (int i = 0; i < ITERATIONS; i++) {
+        Acquire(lock_id);
+        Release(lock_id);
+    }
+    int kernel_ticks = GetTicks() - start;
+    Reclaim(lock_id);
+
+    // User lock: uncontended acquire and release never trap
+    ulock_t ulock = ULOCK_INITIALIZER;
+    start = GetTicks();
+    for (int i = 0; i < ITERATIONS; i++) {
+        ulock_acquire(&ulock);
+        ulock_release(&ulock);
+    }
+    int user_ticks = GetTicks() - start;
+
+    TracePrintf(0, "futex_bench: %d Acquire/Release pairs took %d ticks\n", ITERATIONS, kernel_ticks);
+    TracePrintf(0, "futex_bench: %d ulock_acquire/ulock_release pairs took %d ticks\n", ITERATIONS, user_ticks);
+
+    // A wait on a stale value must return right away instead of blocking
+    int word = 1;
+    int rc = FutexWait(&word, 0);
+    if (rc != FUTEX_VALUE_CHANGED) {
+        TracePrintf(0, "futex_bench: FutexWait on a changed value returned %d\n", rc);
+        Exit(1);
+    }
+    if (FutexWake(&word, 1) != 0) {
+        TracePrintf(0, "futex_bench: FutexWake woke a process that was never waiting\n");
+        Exit(1);
+    }
+
+    Exit(0);
+}
@@ -0,0 +1,63 @@
+#include <yuser.h>
+#include "ext_syscalls.h"
+#include "pcb.h"
+
+// As many old-layout records as fit comfortably in Region 1 next to the split ones
+#define NPROCS 512
+#define PASSES 2000
+
+// The old pcb_t: everything in one record, the contexts and bookkeeping ahead of the scheduling fields
+typedef struct fat_pcb {
+    pcb_cold_t cold;
+    pcb_t hot;
+} fat_pcb_t;
+
+// Link n records of the given size into a circular list, with some other allocations in between like a running kernel
+static list_node_t *build(int size, int node_offset) {
+    list_node_t *head = NULL, *tail = NULL;
+    for (int i = 0; i < NPROCS; i++) {
+        char *rec = malloc(size);
+        if (i % 8 == 0) malloc(64);
+        if (rec == NULL) {
+            TracePrintf(0, "ERROR: out of memory after %d records\n", i);
+            Exit(1);
+        }
+        list_node_t *n = (list_node_t *)(rec + node_offset);
+        pcb_from_queue_node(n)->state = PROCESS_DEFAULT;
+        n->next = NULL;
+        n->prev = tail;
+        if (tail != NULL) tail->next = n;
+        else head = n;
+        tail = n;
+    }
+    tail->next = head;
+    return head;
+}
+
+// What update_delayed_processes does on every tick: follow the node, check the state, count down
+static int walk(list_node_t *first) {
+    int start = GetTicks();
+    for (int p = 0; p < PASSES; p++) {
+        list_node_t *n = first;
+        for (int i = 0; i < NPROCS; i++, n = n->next) {
+            pcb_t *pcb = pcb_from_queue_node(n);
+            if (pcb->state == PROCESS_DEFAULT) pcb->delay_ticks--;
+        }
+    }
+    return GetTicks() - start;
+}
+
+int main(void) {
+    TracePrintf(0, "Hello, pcb_walk_bench!\n");
+
+    // Both lists hold the kernel's real pcb_t, only where it sits differs
+    int fat_ticks = walk(build(sizeof(fat_pcb_t), offsetof(fat_pcb_t, hot) + offsetof(pcb_t, queue_node)));
+    int hot_ticks = walk(build(sizeof(pcb_t), offsetof(pcb_t, queue_node)));
+
+    TracePrintf(0, "pcb_walk_bench: %d records, old layout %d bytes, split layout %d hot + %d cold bytes\n",
+                NPROCS, (int)sizeof(fat_pcb_t), (int)sizeof(pcb_t), (int)sizeof(pcb_cold_t));
+    TracePrintf(0, "pcb_walk_bench: %d walks took %d ticks with the old layout and %d with the split one\n",
+                PASSES, fat_ticks, hot_ticks);
+
+    Exit(0);
+}
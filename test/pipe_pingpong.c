@@ -0,0 +1,54 @@
+#include <yuser.h>
+#include "ext_syscalls.h"
+
+#define ROUNDS 2000
+#define HOGS 2
+
+int main(void) {
+    TracePrintf(0, "Hello, pipe_pingpong!\n");
+
+    int ping, pong, stop;
+    if (PipeInit(&ping) == ERROR || PipeInit(&pong) == ERROR || PipeInit(&stop) == ERROR) {
+        TracePrintf(0, "ERROR: PipeInit failed\n");
+        Exit(1);
+    }
+    PipeSetFlags(stop, PIPE_NONBLOCK);
+
+    // CPU hogs keep the ready queue busy, so a woken peer that goes to the tail has to wait behind them
+    for (int h = 0; h < HOGS; h++) {
+        if (Fork() == 0) {
+            char c;
+            volatile int spin = 0;
+            while (PipeRead(stop, &c, 1) != 1) {
+                for (int i = 0; i < 10000; i++) spin++;
+            }
+            Exit(0);
+        }
+    }
+
+    // The echo side
+    if (Fork() == 0) {
+        char c;
+        for (int i = 0; i < ROUNDS; i++) {
+            PipeRead(ping, &c, 1);
+            PipeWrite(pong, &c, 1);
+        }
+        Exit(0);
+    }
+
+    char c = 'x';
+    int start = GetTicks();
+    for (int i = 0; i < ROUNDS; i++) {
+        PipeWrite(ping, &c, 1);
+        PipeRead(pong, &c, 1);
+    }
+    int ticks = GetTicks() - start;
+
+    TracePrintf(0, "pipe_pingpong: %d round trips with %d hogs took %d ticks, %d.%02d ticks each\n",
+                ROUNDS, HOGS, ticks, ticks / ROUNDS, (ticks * 100 / ROUNDS) % 100);
+
+    for (int h = 0; h < HOGS; h++) PipeWrite(stop, &c, 1);
+    int status;
+    for (int h = 0; h < HOGS + 1; h++) Wait(&status);
+    Exit(0);
+}
@@ -0,0 +1,47 @@
+#include <yuser.h>
+#include "ext_syscalls.h"
+
+#define ROUNDS 1000
+
+int main(void) {
+    TracePrintf(0, "Hello, switch_bench!\n");
+
+    int ping, pong;
+    if (PipeInit(&ping) == ERROR || PipeInit(&pong) == ERROR) {
+        TracePrintf(0, "ERROR: PipeInit failed\n");
+        Exit(1);
+    }
+
+    switch_stats_t before, after;
+    SwitchStats(&before);
+
+    // Each round blocks the parent on pong and the child on ping, so every byte costs a switch each way
+    int pid = Fork();
+    if (pid == 0) {
+        char c;
+        for (int i = 0; i < ROUNDS; i++) {
+            PipeRead(ping, &c, 1);
+            PipeWrite(pong, &c, 1);
+        }
+        Exit(0);
+    }
+    char c = 'x';
+    for (int i = 0; i < ROUNDS; i++) {
+        PipeWrite(ping, &c, 1);
+        PipeRead(pong, &c, 1);
+    }
+    int status;
+    Wait(&status);
+
+    SwitchStats(&after);
+    int switches = after.switches - before.switches;
+    int bytes = after.uctxt_bytes - before.uctxt_bytes;
+    TracePrintf(0, "switch_bench: %d ping-pong rounds made %d switches and copied %d UserContext bytes\n",
+                ROUNDS, switches, bytes);
+    if (switches > 0) {
+        TracePrintf(0, "switch_bench: %d bytes per switch, sizeof(UserContext) is %d\n",
+                    bytes / switches, (int)sizeof(UserContext));
+    }
+
+    Exit(0);
+}
@@ -0,0 +1,78 @@
+/**
+ * File: ulock.h
+ * Description: User space locks and condition variables built on the futex calls
+ *
+ * The lock word is 0 when free, 1 when held, and 2 when held with possible waiters.
+ * Acquire and release stay in user space unless the lock is contended, so the
+ * kernel only sees FutexWait/FutexWake when someone actually has to sleep.
+ * Sharing one between processes needs the lock to live in a shared page.
+ */
+
+#ifndef _ULOCK_H_
+#define _ULOCK_H_
+
+#include "ext_syscalls.h"
+
+typedef struct ulock {
+    volatile int word;
+} ulock_t;
+
+typedef struct ucvar {
+    volatile int seq;  // Bumped on every signal so a sleeping waiter sees the change
+} ucvar_t;
+
+#define ULOCK_INITIALIZER { 0 }
+#define UCVAR_INITIALIZER { 0 }
+
+static inline void ulock_init(ulock_t *lock) {
+    lock->word = 0;
+}
+
+static inline void ulock_acquire(ulock_t *lock) {
+    // Fast path: free -> held without entering the kernel
+    int c = __sync_val_compare_and_swap(&lock->word, 0, 1);
+    if (c == 0) return;
+
+    // Slow path: mark the lock contended and sleep until it is handed back as free
+    if (c != 2) c = __sync_lock_test_and_set(&lock->word, 2);
+    while (c != 0) {
+        FutexWait((int *)&lock->word, 2);
+        c = __sync_lock_test_and_set(&lock->word, 2);
+    }
+}
+
+static inline int ulock_try_acquire(ulock_t *lock) {
+    return __sync_val_compare_and_swap(&lock->word, 0, 1) == 0;
+}
+
+static inline void ulock_release(ulock_t *lock) {
+    // Only enter the kernel if somebody may be sleeping on the lock
+    if (__sync_fetch_and_sub(&lock->word, 1) != 1) {
+        lock->word = 0;
+        FutexWake((int *)&lock->word, 1);
+    }
+}
+
+static inline void ucvar_init(ucvar_t *cvar) {
+    cvar->seq = 0;
+}
+
+static inline void ucvar_wait(ucvar_t *cvar, ulock_t *lock) {
+    int seq = cvar->seq;
+    ulock_release(lock);
+    // Returns right away if a signal already bumped seq after it was read
+    FutexWait((int *)&cvar->seq, seq);
+    ulock_acquire(lock);
+}
+
+static inline void ucvar_signal(ucvar_t *cvar) {
+    __sync_fetch_and_add(&cvar->seq, 1);
+    FutexWake((int *)&cvar->seq, 1);
+}
+
+static inline void ucvar_broadcast(ucvar_t *cvar) {
+    __sync_fetch_and_add(&cvar->seq, 1);
+    FutexWake((int *)&cvar->seq, 0x7fffffff);
+}
+
+#endif /* _ULOCK_H_ */
@@ -4,8 +4,13 @@
 #include "pcb.h"
 #include "list.h"
 #include "syscalls.h"
+#include "mmap.h"
+#include "swap.h"
+#include "memory.h"
+#include "sched.h"
 
 trap_handler_t trap_handlers[TRAP_VECTOR_SIZE];
+unsigned int clock_ticks = 0;
 
 void trap_init(void) {
     TracePrintf(1, "Enter trap_init.\n");
@@ -28,6 +33,10 @@ void kernel_handler(UserContext* cont){
     TracePrintf(1, "Enter Kernel_handler.\n");
     int ind = cont->code ^ YALNIX_PREFIX;
     TracePrintf(1, "Syscall with code %x is being called.\n", ind);
+    // Brk, Mmap and ShmAttach place memory below the stack, keep just the sp current instead of the whole context
+    current_process->cold->user_context.sp = cont->sp;
+    // Pages the last trap was using may be paged out again
+    swap_unpin_all();
     if (ind >= 0 && ind < 256 && syscall_handlers[ind] != NULL){ 
         // If the syscall exists call it
         syscall_handlers[ind](cont);
@@ -39,34 +48,31 @@ void kernel_handler(UserContext* cont){
 
 void clock_handler(UserContext* cont){
     TracePrintf(1, "There has been a clock trap.\n");
+    clock_ticks++;
     // Loops through all delayed processes, decrements their time, and puts them in the ready queue if they're done delaying
     
     update_delayed_processes();
+    // Give up on timed waits that have run out
+    SyncExpireTimeouts();
+    // Periodically see which pages each process has touched
+    if (clock_ticks % WSS_SAMPLE_TICKS == 0) swap_sample_working_sets();
+    // Idle time goes into zeroing frames ahead of Brk and Exec
+    if (current_process == idle_process) zero_pool_refill();
     
-    // Update the current process's run_time
+    // Charge the current process for the tick, the policy decides whether its time is up
     pcb_t *curr = current_process;
-    curr->run_time++;
-    
-    // Check if the current process run_time == it's time slice
-        // If so, change the currently schedeuled process using a KCSwitch
-    if(curr->run_time > curr->time_slice){
-        TracePrintf(1, "The process has reached it's max timeslices %d.\n", curr->time_slice);
-        if(ready_queue->count != 0){
-            // Set the current process's status to the default
-            curr->state = PROCESS_DEFAULT;
-
-            // Schedule another process
-            pcb_t *next = schedule(cont);
-            if(next == NULL){
-                TracePrintf(1, "ERROR, scheduling a new process has failed.\n");
-                return;
-            }
-        } else {
-            TracePrintf(1, "But there were no other processes to run.\n");
+    if(sched_tick(curr)){
+        // Set the current process's status to the default and put it back behind its peers,
+        // unless it overran its real-time budget and has to sit out the rest of its period
+        curr->state = PROCESS_DEFAULT;
+        if(curr != idle_process && !curr->rt_throttled) add_to_ready_queue(curr);
+
+        // Schedule another process
+        pcb_t *next = schedule(cont);
+        if(next == NULL){
+            TracePrintf(1, "ERROR, scheduling a new process has failed.\n");
+            return;
         }
-        
-    } else {
-        TracePrintf(1, "The process has taken %d of %d timeslices.\n", curr->run_time, curr->time_slice);
     }
 
 }
@@ -83,6 +89,7 @@ void memory_handler(UserContext* cont) {
     int regionNumber = ((unsigned long) cont->addr) / VMEM_REGION_SIZE;
     void* relativeMemLocation = regionNumber == 1 ? cont->addr - VMEM_1_BASE : cont->addr;
     int page = (int) relativeMemLocation >> PAGESHIFT;
+    swap_unpin_all();
     // Print the offending address
     TracePrintf(0, "Memory trap: Offending address 0x%lx\n", (unsigned long)cont->addr);
 
@@ -97,7 +104,22 @@ void memory_handler(UserContext* cont) {
         TracePrintf(0, "Region 1 ");
         print_pte(current_process->region1_pt, page);
     }   
-    // ... rest of your memory_handler logic (e.g., handling the trap, potentially halting)
+
+    // Writes to a copy on write zero page get a private frame
+    if (regionNumber == 1 && cont->code == YALNIX_ACCERR && current_process->cold->page_meta[page].cow) {
+        if (cow_break(current_process, page) == 0) return;
+    }
+    // Revoked and paged out pages are restored first, they may belong to a file mapping too
+    if (regionNumber == 1 && swap_fault(page) == SUCCESS) return;
+    // Heap pages below brk get a zeroed frame on their first touch
+    if (regionNumber == 1 && heap_fault(page) == 0) return;
+    // Pages of a file mapping are read in on their first touch
+    if (regionNumber == 1 && mmap_fault(page) == SUCCESS) return;
+
+    // Nothing backs the address, so the process cannot continue
+    TracePrintf(0, "Memory trap: process %d cannot recover from the fault, exiting it.\n", current_process->pid);
+    cont->regs[0] = ERROR;
+    SysExit(cont);
 }
 
 void math_handler(UserContext* cont){
@@ -119,7 +141,7 @@ void receive_handler(UserContext* cont){
     // Check if any process is blocked waiting on a TtyRead for this terminal
         // Get the first waiting process
         // Copy data from buffer to user-space (e.g., using memcpy to process->user_buffer)
-        // Set return value (e.g., in process->user_context->regs[0])
+        // Set return value (e.g., in process->cold->user_context->regs[0])
         // Move the process to the ready queue
 }
 
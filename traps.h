@@ -15,6 +15,9 @@ void trap_init(void); // Initialize the trap handlers
 // Trap handler for system calls (TRAP_KERNEL)
 void kernel_handler(UserContext *cont);
 
+// Number of clock traps since boot
+extern unsigned int clock_ticks;
+
 // Trap handler for clock interrupts (TRAP_CLOCK)
 void clock_handler(UserContext *cont);
 